@@ -0,0 +1,111 @@
+// Stand-ins for what the engine gets from the firmware, for the host checks in this directory: heap_caps on malloc,
+// the log, I_Error and the clock. Each check lists it on its build line; see zone_host.c.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "doomtype.h"
+#include "lprintf.h"
+#include "i_system.h"
+#include "esp_heap_caps.h"
+#include "engine_host.h"
+
+size_t host_heap_free = 64 << 20;
+int host_internal_fail;
+unsigned host_aligned_allocs;
+jmp_buf *host_error_jmp;
+char host_error[256];
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    if ((caps & MALLOC_CAP_INTERNAL) && host_internal_fail)
+        return NULL;
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    if ((caps & MALLOC_CAP_INTERNAL) && host_internal_fail)
+        return NULL;
+    return calloc(n, size);
+}
+
+void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
+{
+    if ((caps & MALLOC_CAP_INTERNAL) && host_internal_fail)
+        return NULL;
+    host_aligned_allocs++;
+    return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return host_heap_free;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    return host_heap_free;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return host_heap_free;
+}
+
+// Warnings and errors only; the engine's timing lines would bury the checks' own output
+int lprintf(OutputLevels pri, const char *fmt, ...)
+{
+    va_list ap;
+    int n = 0;
+
+    if (pri & (LO_WARN | LO_ERROR | LO_FATAL))
+    {
+        va_start(ap, fmt);
+        n = vprintf(fmt, ap);
+        va_end(ap);
+    }
+    return n;
+}
+
+void I_Error(const char *error, ...)
+{
+    va_list ap;
+
+    va_start(ap, error);
+    vsnprintf(host_error, sizeof host_error, error, ap);
+    va_end(ap);
+    if (host_error_jmp)
+        longjmp(*host_error_jmp, 1);
+    printf("I_Error: %s\n", host_error);
+    exit(2);
+}
+
+double host_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+unsigned long I_GetTimeUS(void)
+{
+    return (unsigned long)host_now_us();
+}
+
+unsigned host_rand(void)
+{
+    static uint32_t seed = 1;
+
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) | (seed << 16);
+}
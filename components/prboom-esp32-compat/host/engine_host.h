@@ -0,0 +1,18 @@
+// What engine_host.c stands in for, and the knobs it gives the host checks in this directory.
+
+#ifndef ENGINE_HOST_H
+#define ENGINE_HOST_H
+
+#include <setjmp.h>
+#include <stddef.h>
+
+extern size_t host_heap_free;   // what heap_caps_get_free_size reports, for the zone's low water mark
+extern int host_internal_fail;  // internal RAM allocations fail while set
+extern unsigned host_aligned_allocs; // heap_caps_aligned_alloc calls so far
+extern jmp_buf *host_error_jmp; // I_Error longjmps here while set, and exits otherwise
+extern char host_error[256];    // the message I_Error was given
+
+unsigned host_rand(void);
+double host_now_us(void);
+
+#endif
@@ -0,0 +1,150 @@
+// Host check for the intercept sort in P_TraverseIntercepts, run against p_maputl.c itself, which is included below so
+// its intercept list can be filled. Not part of the firmware build:
+//
+//   cc -O2 -ffunction-sections -fdata-sections -Wl,--gc-sections -Ihost -I../prboom/include
+//      host/intercept_host.c host/engine_host.c ../prboom/z_zone.c -o intercept_host && ./intercept_host
+//
+// (one command; see zone_host.c). Run from components/prboom-esp32-compat. Exits non-zero on a mismatch.
+//
+// Lists of intercepts come in nearly in order, as P_PathTraverse collects them block by block, with equal fracs and
+// some past the end of the trace. P_TraverseIntercepts has to call the traverser on the same intercepts, in the same
+// order, and stop at the same one, as the loop it replaced, which picked the nearest left each time; that loop is
+// kept below as it was. Then both are timed on lists of the lengths shots and long traces make.
+
+#include "../../prboom/p_maputl.c"
+
+#include "engine_host.h"
+
+#define ROUNDS 20000
+#define MAX_INTERCEPTS 400
+#define TIME_ROUNDS 20000
+
+static intercept_t saved[MAX_INTERCEPTS];
+static intptr_t seen[2][MAX_INTERCEPTS];
+static int numseen, stopat;
+
+// P_TraverseIntercepts before the sort, as it was
+static boolean P_TraverseInterceptsScan(traverser_t func, fixed_t maxfrac)
+{
+    intercept_t *in = NULL;
+    int count = intercept_p - intercepts;
+    while (count--)
+    {
+        fixed_t dist = INT_MAX;
+        intercept_t *scan;
+        for (scan = intercepts; scan < intercept_p; scan++)
+            if (scan->frac < dist)
+                dist = (in = scan)->frac;
+        if (dist > maxfrac)
+            return true;    // checked everything in range
+        if (!func(in))
+            return false;   // don't bother going farther
+        in->frac = INT_MAX;
+    }
+    return true;            // everything was traversed
+}
+
+static boolean record(intercept_t *in, int run)
+{
+    seen[run][numseen++] = (intptr_t)in->d.line;
+    return numseen != stopat;
+}
+
+static boolean record_sorted(intercept_t *in)
+{
+    return record(in, 0);
+}
+
+static boolean record_scanned(intercept_t *in)
+{
+    return record(in, 1);
+}
+
+static boolean keep_going(intercept_t *in)
+{
+    return true;
+}
+
+// A trace's intercepts: in order block by block, in any order within a block, often equal, some past its end
+static int make_list(int n)
+{
+    fixed_t frac = -FRACUNIT / 64;
+    int i = 0;
+
+    intercept_p = intercepts;
+    while (i < n)
+    {
+        int block = 1 + host_rand() % 6, j;
+
+        for (j = 0; j < block && i < n; j++, i++)
+        {
+            check_intercept();
+            intercept_p->frac = frac + (host_rand() % 4 ? (fixed_t)(host_rand() % 8) * (FRACUNIT / 256) : 0);
+            intercept_p->isaline = host_rand() % 2;
+            intercept_p->d.line = (line_t *)(intptr_t)(i + 1);
+            intercept_p++;
+        }
+        frac += (fixed_t)(host_rand() % 4) * (FRACUNIT / 256);
+        if (host_rand() % (n / 2 + 1) == 0)
+            frac += FRACUNIT / 2;
+    }
+    return n;
+}
+
+static double time_traverse(boolean (*traverse)(traverser_t, fixed_t), int n)
+{
+    double t = 0, t0;
+    int round;
+
+    for (round = 0; round < TIME_ROUNDS; round++)
+    {
+        make_list(n);
+        t0 = host_now_us();
+        traverse(keep_going, FRACUNIT);
+        t += host_now_us() - t0;
+    }
+    return t / TIME_ROUNDS;
+}
+
+int main(void)
+{
+    static const int lengths[] = { 8, 30, 100, 400 };
+    int round, n, i, failed = 0;
+
+    for (round = 0; round < ROUNDS && !failed; round++)
+    {
+        boolean r0, r1;
+        int count[2];
+
+        n = make_list(host_rand() % (MAX_INTERCEPTS + 1));
+        memcpy(saved, intercepts, n * sizeof *saved);
+        stopat = host_rand() % 4 ? 0 : 1 + host_rand() % (n + 1);
+
+        numseen = 0;
+        r0 = P_TraverseIntercepts(record_sorted, FRACUNIT);
+        count[0] = numseen;
+
+        memcpy(intercepts, saved, n * sizeof *saved);
+        intercept_p = intercepts + n;
+        numseen = 0;
+        r1 = P_TraverseInterceptsScan(record_scanned, FRACUNIT);
+        count[1] = numseen;
+
+        if (r0 != r1 || count[0] != count[1] || memcmp(seen[0], seen[1], count[0] * sizeof *seen[0]))
+        {
+            printf("MISMATCH on %d intercepts, stopping at %d\n", n, stopat);
+            failed = 1;
+        }
+    }
+    if (!failed)
+        printf("intercept sort: %d lists match the nearest first scan\n", ROUNDS);
+
+    for (i = 0; i < (int)(sizeof lengths / sizeof *lengths); i++)
+    {
+        double sorted = time_traverse(P_TraverseIntercepts, lengths[i]);
+        double scanned = time_traverse(P_TraverseInterceptsScan, lengths[i]);
+
+        printf("intercept sort: %3d intercepts %8.2f us sorted %8.2f us scanned\n", lengths[i], sorted, scanned);
+    }
+    return failed;
+}
@@ -0,0 +1,114 @@
+// Host driver for the palette expansion kernels in lcd_conv.c. Checks every kernel against the reference, bit for
+// bit, over random palettes, source data and run lengths (including the odd tails the unrolled loops leave over),
+// then times each one on full frames, with and without a palette change, as select_conv_kernel does on the device.
+// Not part of the firmware build:
+//
+//   cc -O2 -Iinclude host/lcd_conv_host.c lcd_conv.c -o lcd_conv_host && ./lcd_conv_host
+//
+// Run from components/prboom-esp32-compat. Exits non-zero on a mismatch.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lcd_conv.h"
+
+#define FRAME_WORDS (320 * 240 / 4)
+#define MAX_RUN 200
+#define CHECK_ROUNDS 2000
+#define TIME_FRAMES 200
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) | (seed << 16);
+}
+
+static void random_palette(uint16_t *pal)
+{
+    int i;
+
+    for (i = 0; i < 256; i++)
+        pal[i] = rnd();
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main(void)
+{
+    static uint32_t src[FRAME_WORDS];
+    static uint16_t ref[FRAME_WORDS * 4], out[FRAME_WORDS * 4];
+    const lcd_conv_kernel_t *refk = &lcd_conv_kernels[0];
+    uint16_t pal[256];
+    int k, i, round, failed = 0;
+
+    for (k = 1; k < lcd_conv_kernel_count; k++)
+    {
+        const lcd_conv_kernel_t *kern = &lcd_conv_kernels[k];
+        int bad = 0;
+
+        for (round = 0; round < CHECK_ROUNDS && !bad; round++)
+        {
+            int n = rnd() % (MAX_RUN + 1);
+
+            // A new palette now and then, so the kernels' set_palette is checked too
+            if (round % 100 == 0)
+                random_palette(pal);
+            for (i = 0; i < n; i++)
+                src[i] = rnd();
+            // Guard words past the end of the run must not be written
+            memset(ref, 0x5a, (n + 1) * 8);
+            memset(out, 0x5a, (n + 1) * 8);
+
+            if (!refk->set_palette(pal) || !kern->set_palette(pal))
+            {
+                printf("%s: unavailable\n", kern->name);
+                break;
+            }
+            refk->conv(ref, src, n);
+            kern->conv(out, src, n);
+            if (memcmp(ref, out, (n + 1) * 8))
+            {
+                printf("%s: MISMATCH on a run of %d words\n", kern->name, n);
+                bad = failed = 1;
+            }
+        }
+        if (!bad)
+            printf("%s: matches %s\n", kern->name, refk->name);
+    }
+
+    for (i = 0; i < FRAME_WORDS; i++)
+        src[i] = rnd();
+    for (k = 0; k < lcd_conv_kernel_count; k++)
+    {
+        const lcd_conv_kernel_t *kern = &lcd_conv_kernels[k];
+        double t, tpal;
+
+        random_palette(pal);
+        t = now_us();
+        for (i = 0; i < TIME_FRAMES; i++)
+            if (!kern->set_palette(pal))
+                break;
+        tpal = (now_us() - t) / TIME_FRAMES;
+        if (i < TIME_FRAMES)
+            continue;
+
+        t = now_us();
+        for (i = 0; i < TIME_FRAMES; i++)
+            kern->conv(out, src, FRAME_WORDS);
+        t = (now_us() - t) / TIME_FRAMES;
+
+        printf("%-5s %8.1f us/frame %8.1f us/palette %8.1f us/frame with a palette change\n",
+               kern->name, t, tpal, t + tpal);
+    }
+    return failed;
+}
@@ -0,0 +1,260 @@
+// Host check for the sight cache in P_CheckSight, run against p_sight.c itself, which is included below so the
+// uncached check can be called next to it, and p_maputl.c. Not part of the firmware build:
+//
+//   cc -O2 -ffunction-sections -fdata-sections -Wl,--gc-sections -Ihost -I../prboom/include
+//      host/sight_host.c host/engine_host.c ../prboom/p_maputl.c -o sight_host && ./sight_host
+//
+// (one command; see zone_host.c). Run from components/prboom-esp32-compat. Exits non-zero on a mismatch.
+//
+// The map is a row of sectors, each its own subsector of a balanced BSP, split by walls that are solid or open in
+// two halves. Monsters ask about each other as a level would, the same pairs over and over, while some of them move
+// and sectors go up and down, bumping sightgen as T_MovePlane does. Every answer from the cache has to be the one
+// the uncached check gives right then. The same run without the bumps has to give stale answers, or the check
+// above proves nothing. Then what a query costs with and without the cache is timed. Built with -DRANGECHECK,
+// P_CheckSight checks its own hits and I_Errors on the first stale one, in the run without the bumps.
+
+#include "../../prboom/p_sight.c"
+
+#include "engine_host.h"
+
+#define MAPSECTORS 16
+#define MAPLINES ((MAPSECTORS - 1) * 2)
+#define THINGS 24
+#define ROUNDS 200000
+#define SECTORSIZE (256 * FRACUNIT)
+
+int numsectors, numsubsectors, numsegs, numnodes, numlines, numvertexes;
+sector_t *sectors;
+subsector_t *subsectors;
+seg_t *segs;
+node_t *nodes;
+line_t *lines;
+vertex_t *vertexes;
+const byte *rejectmatrix;
+int validcount = 1;
+complevel_t compatibility_level;
+
+static sector_t mapsectors[MAPSECTORS];
+static subsector_t mapsubsectors[MAPSECTORS];
+static seg_t mapsegs[MAPLINES * 2];
+static node_t mapnodes[MAPSECTORS];
+static line_t maplines[MAPLINES];
+static vertex_t mapvertexes[MAPLINES * 2];
+static byte mapreject[(MAPSECTORS * MAPSECTORS + 7) / 8];
+static mobj_t things[THINGS];
+static int failed;
+
+// Only lxdoom_1_compatibility crosses the nodes with this, and it isn't run here
+int R_PointOnSide(fixed_t x, fixed_t y, const node_t *node)
+{
+    failed = 1;
+    return 0;
+}
+
+static int build_nodes(int lo, int hi)
+{
+    node_t *node;
+    int mid = (lo + hi) / 2, front, back;
+
+    if (hi - lo == 1)
+        return lo | NF_SUBSECTOR;
+    front = build_nodes(mid, hi);   // past x, as P_DivlineSide has it
+    back = build_nodes(lo, mid);
+    node = &mapnodes[numnodes];     // after its children, so the head node is last
+    node->x = mid * SECTORSIZE;
+    node->y = 0;
+    node->dx = 0;
+    node->dy = SECTORSIZE;
+    node->children[0] = front;
+    node->children[1] = back;
+    return numnodes++;
+}
+
+static void add_seg(line_t *line, sector_t *front, sector_t *back)
+{
+    seg_t *seg = &mapsegs[numsegs++];
+
+    seg->v1 = line->v1;
+    seg->v2 = line->v2;
+    seg->linedef = line;
+    seg->frontsector = front;
+    seg->backsector = line->flags & ML_TWOSIDED ? back : NULL;
+}
+
+static void set_heights(sector_t *sec)
+{
+    sec->floorheight = (fixed_t)(host_rand() % 3) * 32 * FRACUNIT;
+    sec->ceilingheight = sec->floorheight + (fixed_t)(1 + host_rand() % 3) * 64 * FRACUNIT;
+}
+
+static void make_map(void)
+{
+    int i, j;
+
+    memset(mapsectors, 0, sizeof mapsectors);
+    memset(maplines, 0, sizeof maplines);
+    memset(mapsegs, 0, sizeof mapsegs);
+    numsectors = numsubsectors = MAPSECTORS;
+    numlines = numvertexes = numsegs = numnodes = 0;
+
+    for (i = 0; i < MAPSECTORS; i++)
+    {
+        mapsectors[i].heightsec = -1;
+        set_heights(&mapsectors[i]);
+    }
+
+    // Two lines on each wall between sectors, each solid or open
+    for (i = 1; i < MAPSECTORS; i++)
+        for (j = 0; j < 2; j++)
+        {
+            line_t *line = &maplines[numlines++];
+
+            line->v1 = &mapvertexes[numvertexes++];
+            line->v2 = &mapvertexes[numvertexes++];
+            line->v1->x = line->v2->x = i * SECTORSIZE;
+            line->v1->y = j * SECTORSIZE / 2;
+            line->v2->y = (j + 1) * SECTORSIZE / 2;
+            line->dx = 0;
+            line->dy = SECTORSIZE / 2;
+            line->flags = host_rand() % 4 ? ML_TWOSIDED : 0;
+            line->frontsector = &mapsectors[i];
+            line->backsector = line->flags & ML_TWOSIDED ? &mapsectors[i - 1] : NULL;
+            line->bbox[BOXLEFT] = line->bbox[BOXRIGHT] = line->v1->x;
+            line->bbox[BOXBOTTOM] = line->v1->y;
+            line->bbox[BOXTOP] = line->v2->y;
+        }
+
+    // Each sector is one subsector, with the segs of the walls on its two sides
+    for (i = 0; i < MAPSECTORS; i++)
+    {
+        mapsubsectors[i].sector = &mapsectors[i];
+        mapsubsectors[i].firstline = numsegs;
+        for (j = 0; j < 2; j++)
+        {
+            if (i > 0)
+                add_seg(&maplines[(i - 1) * 2 + j], &mapsectors[i], &mapsectors[i - 1]);
+            if (i < MAPSECTORS - 1)
+                add_seg(&maplines[i * 2 + j], &mapsectors[i], &mapsectors[i + 1]);
+        }
+        mapsubsectors[i].numlines = numsegs - mapsubsectors[i].firstline;
+    }
+    build_nodes(0, MAPSECTORS);
+
+    sectors = mapsectors;
+    subsectors = mapsubsectors;
+    segs = mapsegs;
+    nodes = mapnodes;
+    lines = maplines;
+    vertexes = mapvertexes;
+    rejectmatrix = mapreject;
+}
+
+static void place(mobj_t *mo)
+{
+    int s = host_rand() % MAPSECTORS;
+
+    mo->x = s * SECTORSIZE + (fixed_t)(8 + host_rand() % 240) * FRACUNIT;
+    mo->y = (fixed_t)(8 + host_rand() % 240) * FRACUNIT;
+    mo->subsector = &mapsubsectors[s];
+    mo->z = mapsectors[s].floorheight;
+    mo->height = 56 * FRACUNIT;
+}
+
+// Moves a sector as T_MovePlane would, carrying the things standing in it
+static void move_sector(boolean bump)
+{
+    sector_t *sec = &mapsectors[host_rand() % MAPSECTORS];
+    int i;
+
+    set_heights(sec);
+    for (i = 0; i < THINGS; i++)
+        if (things[i].subsector->sector == sec)
+            things[i].z = sec->floorheight;
+    if (bump)
+        sightgen++;
+}
+
+// Most of what monsters ask is whether they see the player, who is the first thing
+static mobj_t *pick_target(void)
+{
+    return &things[host_rand() % 4 ? 0 : host_rand() % THINGS];
+}
+
+// Runs a level's worth of queries; returns how many cached answers were wrong
+static int run(boolean bump, int rounds)
+{
+    static const int levels[] = { doom_1666_compatibility, mbf_compatibility, prboom_6_compatibility };
+    int round, i, stale = 0;
+
+    for (round = 0; round < rounds; round++)
+    {
+        mobj_t *t1, *t2;
+
+        if (round % 20000 == 0)
+        {
+            make_map();
+            compatibility_level = levels[round / 20000 % 3];
+            for (i = 0; i < THINGS; i++)
+                place(&things[i]);
+            sightgen++;
+        }
+        if (host_rand() % 50 == 0)
+            place(&things[host_rand() % THINGS]);
+        if (host_rand() % 100 == 0)
+            move_sector(bump);
+
+        t1 = &things[host_rand() % THINGS];
+        t2 = pick_target();
+        if (P_CheckSight(t1, t2) != P_CheckSightUncached(t1, t2))
+            stale++;
+    }
+    return stale;
+}
+
+static double time_sight(boolean (*check)(mobj_t *, mobj_t *))
+{
+    static mobj_t *pairs[ROUNDS][2];
+    double t;
+    int i;
+
+    for (i = 0; i < ROUNDS; i++)
+    {
+        pairs[i][0] = &things[host_rand() % THINGS];
+        pairs[i][1] = pick_target();
+    }
+    t = host_now_us();
+    for (i = 0; i < ROUNDS; i++)
+        check(pairs[i][0], pairs[i][1]);
+    return (host_now_us() - t) / ROUNDS;
+}
+
+int main(void)
+{
+    int stale;
+    double cached, uncached;
+
+    sightchecks = sightcached = 0;
+    if (run(true, ROUNDS))
+    {
+        printf("MISMATCH: the cache gave a stale answer\n");
+        failed = 1;
+    }
+    else
+        printf("sight cache: %d queries match, %u%% from the cache\n", ROUNDS, sightcached * 100 / sightchecks);
+
+    stale = run(false, ROUNDS);
+    if (!stale)
+    {
+        printf("MISMATCH: no stale answers without sightgen bumps\n");
+        failed = 1;
+    }
+    else
+        printf("sight cache: %d stale answers when sectors move without a bump, as there should be\n", stale);
+
+    compatibility_level = prboom_6_compatibility;
+    sightgen++;
+    cached = time_sight(P_CheckSight);
+    uncached = time_sight(P_CheckSightUncached);
+    printf("sight cache: %.3f us a query cached, %.3f us uncached\n", cached, uncached);
+    return failed;
+}
@@ -0,0 +1,204 @@
+// Host check for the thinker slabs in p_tick.c, run against p_tick.c itself, which is included below so its statics
+// can be looked at, and z_zone.c. Not part of the firmware build:
+//
+//   cc -O2 -ffunction-sections -fdata-sections -Wl,--gc-sections -Ihost -I../prboom/include
+//      host/slab_host.c host/engine_host.c ../prboom/z_zone.c -o slab_host && ./slab_host
+//
+// (one command; see zone_host.c). Run from components/prboom-esp32-compat. Exits non-zero on a failure.
+//
+// Each level allocates and frees thinkers of more sizes than there are pools, in random order. Every thinker keeps
+// its own byte pattern, so overlaps show up; each has to be aligned for its pointers; a freed thinker has to come
+// back for the next one of its size, last freed first, while the sizes past THINKER_SIZES come from the zone; the
+// slabs in internal RAM mustn't pass THINKER_INTERNAL, and every other level internal RAM runs out so they all come
+// from the zone. P_FreeThinkerSlabs and Z_FreeTags then have to leave nothing behind.
+//
+// It also gives how many slabs the mobjs of a level end up in, and what allocating a thinker costs against
+// Z_Malloc, which they came from before.
+
+#include "../../prboom/p_tick.c"
+
+#include "engine_host.h"
+
+#define LEVELS 20
+#define LEVEL_THINKERS 5000
+#define SIZES (THINKER_SIZES + 4)
+
+typedef struct {
+    unsigned char *p;
+    size_t size;
+    int seed;
+} hostthinker_t;
+
+static hostthinker_t things[LEVEL_THINKERS];
+static size_t sizes[SIZES];
+static void *freed[SIZES][LEVEL_THINKERS];
+static int numfreed[SIZES];
+static int failed;
+
+static void fail(const char *what, int round)
+{
+    if (!failed)
+        printf("MISMATCH: %s (round %d)\n", what, round);
+    failed = 1;
+}
+
+static void fill(const hostthinker_t *t)
+{
+    size_t i;
+
+    for (i = 0; i < t->size; i++)
+        t->p[i] = (unsigned char)(t->seed + i * 7);
+}
+
+static boolean intact(const hostthinker_t *t)
+{
+    size_t i;
+
+    for (i = 0; i < t->size; i++)
+        if (t->p[i] != (unsigned char)(t->seed + i * 7))
+            return false;
+    return true;
+}
+
+static int size_index(size_t size)
+{
+    int i;
+
+    for (i = 0; i < SIZES && sizes[i] != size; i++)
+        ;
+    return i;
+}
+
+static boolean has_pool(size_t size)
+{
+    int i;
+
+    for (i = 0; i < numthinkerpools; i++)
+        if (thinkerpools[i].size == ((size + 7) & ~7))
+            return true;
+    return false;
+}
+
+static boolean in_slab(const void *p)
+{
+    const thinkerslab_t *slab;
+
+    for (slab = thinkerslabs; slab; slab = slab->next)
+        if ((const byte *)p >= slab->start && (const byte *)p < slab->end)
+            return true;
+    return false;
+}
+
+static void check_slabs(void)
+{
+    int round, i;
+
+    for (i = 0; i < SIZES; i++)
+        sizes[i] = 20 + 24 * i;
+
+    for (round = 0; round < LEVELS; round++)
+    {
+        const thinkerslab_t *slab;
+        size_t internal = 0;
+
+        host_internal_fail = round % 2;
+        memset(numfreed, 0, sizeof numfreed);
+        for (i = 0; i < LEVEL_THINKERS; i++)
+        {
+            hostthinker_t *t = &things[i];
+            int s = host_rand() % SIZES;
+
+            t->size = sizes[s];
+            t->seed = host_rand();
+            t->p = P_AllocThinker(t->size);
+            if ((uintptr_t)t->p % 8)
+                fail("thinker not aligned", round);
+            if (numfreed[s] && in_slab(t->p) && t->p != freed[s][numfreed[s] - 1])
+                fail("freed thinker of the same size not reused, last freed first", round);
+            if (numfreed[s] && in_slab(t->p))
+                numfreed[s]--;
+            fill(t);
+
+            // Free some of what's there as the level goes, to be reused
+            if (host_rand() % 3 == 0)
+            {
+                hostthinker_t *f = &things[host_rand() % (i + 1)];
+                if (f->p)
+                {
+                    if (in_slab(f->p))
+                    {
+                        s = size_index(f->size);
+                        freed[s][numfreed[s]++] = f->p;
+                    }
+                    P_FreeThinker((thinker_t *)f->p);
+                    f->p = NULL;
+                }
+            }
+        }
+
+        for (i = 0; i < LEVEL_THINKERS; i++)
+            if (things[i].p)
+            {
+                if (!intact(&things[i]))
+                    fail("thinker overwritten", round);
+                if (!has_pool(things[i].size) != !in_slab(things[i].p))
+                    fail("thinker in the wrong place for its size", round);
+            }
+        if (numthinkerpools != THINKER_SIZES)
+            fail("pools not all used", round);
+        for (slab = thinkerslabs; slab; slab = slab->next)
+            if (slab->internal)
+                internal += slab->end - slab->start + sizeof *slab;
+        if (internal != internalslabs || internalslabs > THINKER_INTERNAL)
+            fail("internal slabs over their budget", round);
+        if (host_internal_fail && internalslabs)
+            fail("internal slab with no internal RAM", round);
+        if (!host_internal_fail && !internalslabs)
+            fail("no internal slabs", round);
+
+        P_FreeThinkerSlabs();
+        Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+        if (thinkerslabs || numthinkerpools || internalslabs)
+            fail("slabs left after P_FreeThinkerSlabs", round);
+        if (zonestats.bytes[PU_LEVEL] || zonestats.blocks[PU_LEVEL])
+            fail("zone slabs left after Z_FreeTags", round);
+        memset(things, 0, sizeof things);
+    }
+    host_internal_fail = 0;
+
+    if (!failed)
+        printf("thinker slabs: %d levels of %d thinkers in %d sizes match\n", LEVELS, LEVEL_THINKERS, SIZES);
+}
+
+// Where the mobjs of a level end up, and what getting them costs, with the slabs and with Z_Malloc
+static void measure(void)
+{
+    const thinkerslab_t *slab;
+    double t;
+    int i, slabs = 0;
+
+    t = host_now_us();
+    for (i = 0; i < LEVEL_THINKERS; i++)
+        P_AllocThinker(sizeof(mobj_t));
+    t = host_now_us() - t;
+    for (slab = thinkerslabs; slab; slab = slab->next)
+        slabs++;
+    printf("thinker slabs: %d mobjs of %d bytes in %d slabs, %.3f us each\n",
+           LEVEL_THINKERS, (int)sizeof(mobj_t), slabs, t / LEVEL_THINKERS);
+    P_FreeThinkerSlabs();
+    Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+
+    t = host_now_us();
+    for (i = 0; i < LEVEL_THINKERS; i++)
+        Z_Malloc(sizeof(mobj_t), PU_LEVEL, NULL);
+    t = host_now_us() - t;
+    printf("thinker slabs: the same from Z_Malloc, %.3f us each\n", t / LEVEL_THINKERS);
+    Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+}
+
+int main(void)
+{
+    check_slabs();
+    measure();
+    return failed;
+}
@@ -0,0 +1,257 @@
+// Host check for the sound flood in P_NoiseAlert, run against p_enemy.c itself, which is included below so its graph
+// can be built, and p_maputl.c, whose P_LineOpening the old recursion used. Not part of the firmware build:
+//
+//   cc -O2 -ffunction-sections -fdata-sections -Wl,--gc-sections -Ihost -I../prboom/include
+//      host/sound_host.c host/engine_host.c ../prboom/p_maputl.c ../prboom/z_zone.c -o sound_host && ./sound_host
+//
+// (one command; see zone_host.c). Run from components/prboom-esp32-compat. Exits non-zero on a mismatch.
+//
+// Random maps of sectors joined by lines that are one-sided, two-sided, missing their second side, sound blocking,
+// closed by their heights, or lead back into the same sector. Each gets P_InitSoundGraph and then a noise from every
+// sector; the sectors it reaches, their soundtraversed and soundtarget have to be what P_RecursiveSound, kept below as
+// it was, gives for the same noise. A map of more sectors than the graph's 16 bit numbers hold has to be refused.
+// Then both are timed on a map the size of a big level.
+
+#include "../../prboom/p_enemy.c"
+
+#include "engine_host.h"
+
+#define GRAPHS 20000
+#define MAX_SECTORS 40
+#define MAX_LINES 120
+#define BIG_SECTORS 1000
+#define BIG_LINES 3000
+#define TIME_ROUNDS 2000
+
+int numsectors, numlines, numsides;
+sector_t *sectors;
+line_t *lines;
+side_t *sides;
+int validcount = 1;
+
+static sector_t mapsectors[BIG_SECTORS];
+static line_t maplines[BIG_LINES];
+static side_t mapsides[BIG_LINES * 2];
+static line_t *linelists[BIG_SECTORS][BIG_LINES];   // each sector's lines, both sides' in one
+static mobj_t targets[2];
+
+static struct {
+    int reached, soundtraversed;
+    mobj_t *soundtarget;
+} heard[BIG_SECTORS];
+
+void P_SetTarget(mobj_t **mop, mobj_t *targ)
+{
+    *mop = targ;
+}
+
+// P_RecursiveSound before the flood, as it was
+static void P_RecursiveSound(sector_t *sec, int soundblocks, mobj_t *soundtarget)
+{
+    int i;
+
+    // wake up all monsters in this sector
+    if (sec->validcount == validcount && sec->soundtraversed <= soundblocks + 1)
+        return;             // already flooded
+
+    sec->validcount = validcount;
+    sec->soundtraversed = soundblocks + 1;
+    P_SetTarget(&sec->soundtarget, soundtarget);
+
+    for (i = 0; i < sec->linecount; i++)
+    {
+        sector_t *other;
+        line_t *check = sec->lines[i];
+
+        if (!(check->flags & ML_TWOSIDED))
+            continue;
+
+        P_LineOpening(check);
+
+        if (openrange <= 0)
+            continue;       // closed door
+
+        other = sides[check->sidenum[sides[check->sidenum[0]].sector == sec]].sector;
+
+        if (!(check->flags & ML_SOUNDBLOCK))
+            P_RecursiveSound(other, soundblocks, soundtarget);
+        else if (!soundblocks)
+            P_RecursiveSound(other, 1, soundtarget);
+    }
+}
+
+static void P_NoiseAlertRecursive(mobj_t *target, mobj_t *emitter)
+{
+    validcount++;
+    P_RecursiveSound(emitter->subsector->sector, 0, target);
+}
+
+static void add_line(sector_t *sec, line_t *line)
+{
+    sec->lines[sec->linecount++] = line;
+}
+
+static void make_map(int nsectors, int nlines)
+{
+    int i;
+
+    numsectors = nsectors;
+    numlines = nlines;
+    numsides = 0;
+    for (i = 0; i < nsectors; i++)
+    {
+        sector_t *sec = &mapsectors[i];
+
+        memset(sec, 0, sizeof *sec);
+        sec->lines = linelists[i];
+        sec->floorheight = (fixed_t)(host_rand() % 3) * 64 * FRACUNIT;
+        sec->ceilingheight = sec->floorheight + (fixed_t)(host_rand() % 8 ? 1 + host_rand() % 2 : 0) * 64 * FRACUNIT;
+    }
+
+    for (i = 0; i < nlines; i++)
+    {
+        line_t *line = &maplines[i];
+        sector_t *front = &mapsectors[host_rand() % nsectors];
+        sector_t *back = host_rand() % 20 ? &mapsectors[host_rand() % nsectors] : front;
+        int kind = host_rand() % 20;
+
+        memset(line, 0, sizeof *line);
+        line->flags = (kind ? ML_TWOSIDED : 0) | (host_rand() % 4 ? 0 : ML_SOUNDBLOCK);
+        line->sidenum[0] = numsides;
+        mapsides[numsides++].sector = front;
+        line->frontsector = front;
+        add_line(front, line);
+        if (kind < 2)
+            line->sidenum[1] = NO_INDEX;    // one-sided, or two-sided with its second side gone
+        else
+        {
+            line->sidenum[1] = numsides;
+            mapsides[numsides++].sector = back;
+            line->backsector = back;
+            if (back != front)
+                add_line(back, line);
+        }
+    }
+
+    sectors = mapsectors;
+    lines = maplines;
+    sides = mapsides;
+}
+
+static void clear_sound(void)
+{
+    int i;
+
+    for (i = 0; i < numsectors; i++)
+    {
+        sectors[i].soundtraversed = 0;
+        sectors[i].soundtarget = NULL;
+    }
+}
+
+static void save_heard(void)
+{
+    int i;
+
+    for (i = 0; i < numsectors; i++)
+    {
+        heard[i].reached = sectors[i].validcount == validcount;
+        heard[i].soundtraversed = sectors[i].soundtraversed;
+        heard[i].soundtarget = sectors[i].soundtarget;
+    }
+}
+
+static boolean same_heard(void)
+{
+    int i;
+
+    for (i = 0; i < numsectors; i++)
+    {
+        int reached = sectors[i].validcount == validcount;
+
+        if (reached != heard[i].reached)
+            return false;
+        if (reached && (sectors[i].soundtraversed != heard[i].soundtraversed ||
+                        sectors[i].soundtarget != heard[i].soundtarget))
+            return false;
+    }
+    return true;
+}
+
+static double time_alert(void (*alert)(mobj_t *, mobj_t *), mobj_t *emitters)
+{
+    double t = host_now_us();
+    int i;
+
+    for (i = 0; i < TIME_ROUNDS; i++)
+        alert(&targets[0], &emitters[i % numsectors]);
+    return (host_now_us() - t) / TIME_ROUNDS;
+}
+
+int main(void)
+{
+    static subsector_t subsectors[BIG_SECTORS];
+    static mobj_t emitters[BIG_SECTORS];
+    jmp_buf jb;
+    int graph, i, failed = 0, reached = 0, blocked = 0;
+    double flood, recursive;
+
+    for (i = 0; i < BIG_SECTORS; i++)
+    {
+        subsectors[i].sector = &mapsectors[i];
+        emitters[i].subsector = &subsectors[i];
+    }
+
+    for (graph = 0; graph < GRAPHS && !failed; graph++)
+    {
+        mobj_t *target = &targets[graph % 2];
+
+        make_map(1 + host_rand() % MAX_SECTORS, host_rand() % (MAX_LINES + 1));
+        P_InitSoundGraph();
+        for (i = 0; i < numsectors && !failed; i++)
+        {
+            int j;
+
+            clear_sound();
+            P_NoiseAlert(target, &emitters[i]);
+            save_heard();
+            clear_sound();
+            P_NoiseAlertRecursive(target, &emitters[i]);
+            if (!same_heard())
+            {
+                printf("MISMATCH: graph %d of %d sectors and %d lines, noise in sector %d\n",
+                       graph, numsectors, numlines, i);
+                failed = 1;
+            }
+            for (j = 0; j < numsectors; j++)
+                if (heard[j].reached)
+                {
+                    reached++;
+                    blocked += heard[j].soundtraversed == 2;
+                }
+        }
+        Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+    }
+    if (!failed)
+        printf("sound flood: %d graphs match the recursion, %d sectors heard, %d of them past a blocking line\n",
+               GRAPHS, reached, blocked);
+
+    numsectors = 0x10000;
+    host_error_jmp = &jb;
+    if (!setjmp(jb))
+    {
+        P_InitSoundGraph();
+        printf("MISMATCH: sound graph built for %d sectors\n", numsectors);
+        failed = 1;
+    }
+    host_error_jmp = NULL;
+
+    make_map(BIG_SECTORS, BIG_LINES);
+    P_InitSoundGraph();
+    flood = time_alert(P_NoiseAlert, emitters);
+    recursive = time_alert(P_NoiseAlertRecursive, emitters);
+    printf("sound flood: %d sectors and %d lines, %.2f us a noise flooded, %.2f us recursing\n",
+           BIG_SECTORS, BIG_LINES, flood, recursive);
+    Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+    return failed;
+}
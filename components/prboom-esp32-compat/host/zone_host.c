@@ -0,0 +1,367 @@
+// Host checks for the level arena and the least recently used eviction of PU_CACHE blocks, run against z_zone.c
+// itself, which is included below so its statics can be looked at. Not part of the firmware build:
+//
+//   cc -O2 -ffunction-sections -fdata-sections -Wl,--gc-sections -Ihost -I../prboom/include
+//      host/zone_host.c host/engine_host.c -o zone_host && ./zone_host
+//
+// (one command). The section flags let the linker drop the parts of the engine the checks don't reach, and with
+// them what those would need from the rest of it.
+//
+// Run from components/prboom-esp32-compat. Exits non-zero on a failure.
+//
+// The arena check runs levels of random PU_LEVEL/PU_LEVSPEC allocations and frees, with and without owners, mixed
+// with PU_STATIC ones. Every block keeps its own byte pattern, so overlapping blocks show up; a freed arena block
+// has to come back for the next one of its size, last freed first; the zone's accounting has to match; moving an
+// arena block off the level tags has to be refused; and at level end Z_FreeTags has to clear every owner and give
+// back every chunk, leaving the PU_STATIC blocks alone. It gives how full the chunks were and how long
+// Z_FreeTags took.
+//
+// The eviction check locks and unlocks PU_CACHE blocks the way W_LockLumpNum and W_UnlockLumpNum do, keeps its
+// own list of them from least to most recently unlocked, and has Z_EvictCache (directly, and through Z_Malloc's
+// low water mark) free random amounts. The blocks freed have to be exactly the front of that list that covers the
+// amount, and no locked block may go.
+
+#include "../../prboom/z_zone.c"
+
+#include "engine_host.h"
+
+#define LEVELS 40
+#define LEVEL_BLOCKS 3000
+#define CACHE_BLOCKS 300
+#define CACHE_ROUNDS 20000
+
+typedef struct {
+    unsigned char *p;
+    size_t size;
+    int tag, seed;
+    void *user;         // set by the zone while owned
+    boolean owned;
+} hostblock_t;
+
+static int failed;
+
+static void fail(const char *what, int round)
+{
+    if (!failed)
+        printf("MISMATCH: %s (round %d)\n", what, round);
+    failed = 1;
+}
+
+static void fill(const hostblock_t *b)
+{
+    size_t i;
+
+    for (i = 0; i < b->size; i++)
+        b->p[i] = (unsigned char)(b->seed + i * 7);
+}
+
+static boolean intact(const hostblock_t *b)
+{
+    size_t i;
+
+    for (i = 0; i < b->size; i++)
+        if (b->p[i] != (unsigned char)(b->seed + i * 7))
+            return false;
+    return true;
+}
+
+static boolean in_arena(const void *p)
+{
+    const arenachunk_t *chunk;
+
+    for (chunk = arena; chunk; chunk = chunk->next)
+        if ((const char *)p >= (const char *)chunk && (const char *)p < (const char *)chunk + ARENA_CHUNK)
+            return true;
+    return false;
+}
+
+static size_t rounded(size_t size)
+{
+    return (size + CHUNK_SIZE - 1) & ~(CHUNK_SIZE - 1);
+}
+
+//
+// Level arena
+//
+
+static hostblock_t level[LEVEL_BLOCKS];
+static unsigned char *freedarena[ARENA_MAXBLOCK / CHUNK_SIZE + 1][LEVEL_BLOCKS];
+static int numfreed[ARENA_MAXBLOCK / CHUNK_SIZE + 1];
+
+static void alloc_level_block(hostblock_t *b, int round)
+{
+    int tag = host_rand() % 8 == 0 ? PU_STATIC : host_rand() % 4 ? PU_LEVEL : PU_LEVSPEC;
+    size_t size = host_rand() % 3 ? 1 + host_rand() % ARENA_MAXBLOCK : 1 + host_rand() % (4 * ARENA_MAXBLOCK);
+    int cls = rounded(size) / CHUNK_SIZE;
+    boolean reuse = Z_IsLevelTag(tag) && size <= ARENA_MAXBLOCK && numfreed[cls];
+
+    b->owned = host_rand() % 2;
+    b->size = size;
+    b->tag = tag;
+    b->seed = host_rand();
+    b->p = Z_Malloc(size, tag, b->owned ? &b->user : NULL);
+    if (b->owned && b->user != b->p)
+        fail("owner not set", round);
+    if ((uintptr_t)b->p % CHUNK_SIZE)
+        fail("block not aligned", round);
+    if (reuse && b->p != freedarena[cls][--numfreed[cls]])
+        fail("freed arena block of the same size not reused, last freed first", round);
+    if (!reuse && Z_IsLevelTag(tag) && size <= ARENA_MAXBLOCK && !in_arena(b->p))
+        fail("small level block not from the arena", round);
+    if ((tag == PU_STATIC || size > ARENA_MAXBLOCK) && in_arena(b->p))
+        fail("static or big block from the arena", round);
+    fill(b);
+}
+
+static void free_level_block(hostblock_t *b)
+{
+    if (in_arena(b->p))
+    {
+        int cls = rounded(b->size) / CHUNK_SIZE;
+        freedarena[cls][numfreed[cls]++] = b->p;
+    }
+    Z_Free(b->p);
+    if (b->owned && b->user)
+        fail("owner not cleared by Z_Free", 0);
+    b->p = NULL;
+}
+
+static void check_arena(void)
+{
+    double t = 0;
+    int round, i, chunks = 0, blocks = 0;
+    size_t used = 0;
+
+    for (round = 0; round < LEVELS; round++)
+    {
+        jmp_buf jb;
+        const arenachunk_t *chunk;
+        size_t levelbytes = 0, staticbytes;
+        double t0;
+
+        memset(numfreed, 0, sizeof numfreed);
+        for (i = 0; i < LEVEL_BLOCKS; i++)
+        {
+            // The last level's static blocks go now
+            if (level[i].p)
+                free_level_block(&level[i]);
+            alloc_level_block(&level[i], round);
+            // Free some of what's there as the level goes, to be reused
+            if (host_rand() % 3 == 0)
+            {
+                hostblock_t *b = &level[host_rand() % (i + 1)];
+                if (b->p && b->tag != PU_STATIC)
+                    free_level_block(b);
+            }
+        }
+
+        for (i = 0; i < LEVEL_BLOCKS; i++)
+            if (level[i].p)
+            {
+                if (!intact(&level[i]))
+                    fail("block overwritten", round);
+                if (level[i].tag != PU_STATIC)
+                {
+                    levelbytes += rounded(level[i].size);
+                    blocks++;
+                }
+            }
+        if (zonestats.bytes[PU_LEVEL] + zonestats.bytes[PU_LEVSPEC] != levelbytes)
+            fail("level tag accounting", round);
+
+        // A level block can change level tags but mustn't outlive the level
+        for (i = 0; i < LEVEL_BLOCKS && !(level[i].p && level[i].owned && in_arena(level[i].p)); i++)
+            ;
+        if (i < LEVEL_BLOCKS)
+        {
+            Z_ChangeTag(level[i].p, PU_LEVSPEC);
+            level[i].tag = PU_LEVSPEC;
+            host_error_jmp = &jb;
+            if (!setjmp(jb))
+            {
+                Z_ChangeTag(level[i].p, PU_CACHE);
+                fail("arena block moved to PU_CACHE", round);
+            }
+            host_error_jmp = NULL;
+        }
+
+        for (chunk = arena; chunk; chunk = chunk->next)
+        {
+            used += chunk->used;
+            chunks++;
+        }
+
+        staticbytes = zonestats.bytes[PU_STATIC];
+        t0 = host_now_us();
+        Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+        t += host_now_us() - t0;
+
+        if (arena || arena_inuse)
+            fail("arena left after Z_FreeTags", round);
+        for (i = 0; i <= ARENA_MAXBLOCK / CHUNK_SIZE; i++)
+            if (arenafree[i])
+                fail("arena free list left after Z_FreeTags", round);
+        if (zonestats.bytes[PU_LEVEL] || zonestats.blocks[PU_LEVEL] ||
+            zonestats.bytes[PU_LEVSPEC] || zonestats.blocks[PU_LEVSPEC])
+            fail("level tags still counted after Z_FreeTags", round);
+        if (zonestats.bytes[PU_STATIC] < staticbytes)
+            fail("static blocks lost with the level", round);
+        for (i = 0; i < LEVEL_BLOCKS; i++)
+            if (level[i].p && level[i].tag != PU_STATIC)
+            {
+                if (level[i].owned && level[i].user)
+                    fail("owner not cleared by Z_FreeTags", round);
+                level[i].p = NULL;
+            }
+            else if (level[i].p && !intact(&level[i]))
+                fail("static block overwritten", round);
+    }
+
+    for (i = 0; i < LEVEL_BLOCKS; i++)
+        if (level[i].p)
+            free_level_block(&level[i]);
+
+    if (!failed)
+        printf("level arena: %d levels of %d blocks match\n", LEVELS, LEVEL_BLOCKS);
+    printf("level arena: %d blocks left a level in %.1f chunks, %.0f%% used, freed in %.1f us\n",
+           blocks / LEVELS, (double)chunks / LEVELS, used * 100.0 / ((double)chunks * ARENA_CHUNK), t / LEVELS);
+}
+
+//
+// LRU eviction
+//
+
+static hostblock_t cache[CACHE_BLOCKS];
+static int lru[CACHE_BLOCKS], numlru;   // unlocked blocks, least recently unlocked first
+
+static void lru_remove(int b)
+{
+    int i;
+
+    for (i = 0; i < numlru && lru[i] != b; i++)
+        ;
+    memmove(lru + i, lru + i + 1, (numlru - i - 1) * sizeof *lru);
+    numlru--;
+}
+
+static void cache_load(int b)
+{
+    cache[b].size = 32 + host_rand() % (8 * 1024);
+    cache[b].seed = host_rand();
+    cache[b].owned = true;
+    cache[b].p = Z_Malloc(cache[b].size, PU_CACHE, &cache[b].user);
+    fill(&cache[b]);
+    lru[numlru++] = b;
+}
+
+// The blocks the model says an eviction of want bytes takes, from the front
+static int victims(size_t want)
+{
+    size_t freed = 0;
+    int n = 0;
+
+    while (n < numlru && freed < want)
+        freed += rounded(cache[lru[n++]].size) + HEADER_SIZE;
+    return n;
+}
+
+static void check_evicted(int n, int round)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        if (cache[lru[i]].user)
+            fail("a least recently used block was kept", round);
+    for (i = n; i < numlru; i++)
+        if (!cache[lru[i]].user)
+            fail("a more recently used block was evicted", round);
+    for (i = 0; i < CACHE_BLOCKS; i++)
+        if (cache[i].tag == PU_STATIC && (!cache[i].user || !intact(&cache[i])))
+            fail("a locked block was evicted", round);
+    for (i = 0; i < n; i++)
+        cache[lru[i]].p = NULL;
+    memmove(lru, lru + n, (numlru - n) * sizeof *lru);
+    numlru -= n;
+}
+
+static void check_lru(void)
+{
+    unsigned evictions = zonestats.evictions;
+    double t = 0;
+    int round, i;
+
+    for (i = 0; i < CACHE_BLOCKS; i++)
+    {
+        cache[i].tag = PU_CACHE;
+        cache_load(i);
+    }
+
+    for (round = 0; round < CACHE_ROUNDS && !failed; round++)
+    {
+        int b = host_rand() % CACHE_BLOCKS;
+        int op = host_rand() % 16;
+
+        if (!cache[b].p)
+        {
+            // Read again after it was evicted, as W_CacheLumpNum would
+            cache_load(b);
+        }
+        else if (op < 12)
+        {
+            // W_LockLumpNum, then W_UnlockLumpNum, now or some rounds later
+            if (cache[b].tag == PU_CACHE)
+            {
+                Z_ChangeTag(cache[b].p, PU_STATIC);
+                cache[b].tag = PU_STATIC;
+                lru_remove(b);
+            }
+            if (op < 8)
+            {
+                if (!intact(&cache[b]))
+                    fail("block overwritten", round);
+                Z_ChangeTag(cache[b].p, PU_CACHE);
+                cache[b].tag = PU_CACHE;
+                lru[numlru++] = b;
+            }
+        }
+        else if (op < 15)
+        {
+            size_t want = host_rand() % (64 * 1024);
+            int n = victims(want);
+            double t0 = host_now_us();
+
+            Z_EvictCache(want);
+            t += host_now_us() - t0;
+            check_evicted(n, round);
+        }
+        else
+        {
+            // Z_Malloc below the low water mark makes room first
+            size_t size = 32 + host_rand() % 4096, short_by = host_rand() % (64 * 1024);
+            void *p;
+            int n = victims(short_by);
+
+            host_heap_free = ZONE_LOW_WATER + rounded(size) + HEADER_SIZE - short_by;
+            p = Z_Malloc(size, PU_STATIC, NULL);
+            host_heap_free = 64 << 20;
+            check_evicted(n, round);
+            Z_Free(p);
+        }
+    }
+
+    for (i = 0; i < CACHE_BLOCKS; i++)
+        if (cache[i].p)
+            Z_Free(cache[i].p);
+
+    if (!failed)
+        printf("LRU eviction: %d rounds match\n", CACHE_ROUNDS);
+    printf("LRU eviction: %u blocks evicted, %.2f us each\n", zonestats.evictions - evictions,
+           t / (zonestats.evictions - evictions));
+}
+
+int main(void)
+{
+    check_arena();
+    check_lru();
+    return failed;
+}
@@ -66,6 +66,7 @@
 #include "lprintf.h"
 #include "m_fixed.h"
 #include "r_fps.h"
+#include "r_main.h"
 #include "i_system.h"
 #include "i_joy.h"
 
@@ -75,6 +76,7 @@
 #include "esp_partition.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #ifdef __GNUG__
 #pragma implementation "i_system.h"
@@ -82,39 +84,77 @@
 #include "i_system.h"
 
 #include <sys/time.h>
+#include <time.h>
+
+#if defined SPLIT_RENDER || defined PIPELINE_RENDER
+#include <pthread.h>
+#ifdef ESP_PLATFORM
+#include "esp_pthread.h"
+#endif
+#endif
 
 int realtime=0;
 
+// Monotonic microseconds since boot. Everything below keeps time with
+// this; gettimeofday jumps when the clock is set and is slower to read.
+static int64_t getUsTicks(void)
+{
+    return esp_timer_get_time();
+}
+
+// The FreeRTOS tick is 10ms, far too coarse to sleep up to the next tic
+// with, so I_uSleep has an esp_timer wake the task with a notification
+// and spins through the last SLEEP_SPIN_US, which covers the timer
+// task's latency.
+#define SLEEP_SPIN_US 100
 
-void I_uSleep(unsigned long usecs)
+static esp_timer_handle_t sleepTimer;
+static TaskHandle_t sleepingTask;
+
+static void sleepTimerCb(void *arg)
 {
-	vTaskDelay(usecs/1000);
+    xTaskNotifyGive(sleepingTask);
 }
 
-static unsigned long getMsTicks() {
-  struct timeval tv;
-  struct timezone tz;
-//  unsigned long thistimereply;
+void I_uSleep(unsigned long usecs)
+{
+    int64_t until = getUsTicks() + usecs;
+    int64_t left;
 
-  gettimeofday(&tv, &tz);
+    while ((left = until - getUsTicks()) > SLEEP_SPIN_US)
+    {
+        if (!sleepTimer)
+        {
+            const esp_timer_create_args_t args = {
+                .callback = sleepTimerCb,
+                .name = "usleep",
+            };
+            ESP_ERROR_CHECK(esp_timer_create(&args, &sleepTimer));
+        }
+        // A stray notification ends the wait early, the loop then sleeps again
+        esp_timer_stop(sleepTimer);
+        sleepingTask = xTaskGetCurrentTaskHandle();
+        esp_timer_start_once(sleepTimer, left - SLEEP_SPIN_US);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    while (getUsTicks() < until)
+        ;
+}
 
-  //convert to ms
-  unsigned long now = tv.tv_usec/1000+tv.tv_sec*1000;
-  return now;
+static unsigned long getMsTicks() {
+  return getUsTicks() / 1000;
 }
 
 int I_GetTime_RealTime (void)
 {
-  struct timeval tv;
-  struct timezone tz;
-  unsigned long thistimereply;
-
-  gettimeofday(&tv, &tz);
+  int64_t now = getUsTicks();
+  int thistimereply = now * TICRATE / 1000000;
 
-  thistimereply = (tv.tv_sec * TICRATE + (tv.tv_usec * TICRATE) / 1000000);
+  // How long until the next tic is due, for TryRunTics
+  us_to_next_tick = ((int64_t)(thistimereply + 1) * 1000000 + TICRATE - 1) / TICRATE - now;
+  ms_to_next_tick = us_to_next_tick / 1000;
 
   return thistimereply;
-
 }
 
 const int displaytime=0;
@@ -141,8 +181,36 @@ fixed_t I_GetTimeFrac (void)
 }
 
 
+// Tic jitter: how late after it was due each tic starts, over the last
+// TICSTATS_TICS tics, logged while rendering_stats is on.
+#define TICSTATS_TICS (TICRATE*10)
+
+static void I_TicStats(void)
+{
+  static int tics, total, worst;
+  static uint32_t evictions, evictbytes, evictus;
+  int late = getUsTicks() * TICRATE % 1000000 / TICRATE;
+
+  total += late;
+  if (late > worst)
+    worst = late;
+  if (++tics == TICSTATS_TICS)
+  {
+    if (rendering_stats)
+      lprintf(LO_INFO, "tic jitter: avg %dus, max %dus; cache evicted %u blocks, %uKB in %uus\n",
+              total / tics, worst, zonestats.evictions - evictions,
+              (zonestats.evictbytes - evictbytes) / 1024, zonestats.evictus - evictus);
+    tics = total = worst = 0;
+    evictions = zonestats.evictions;
+    evictbytes = zonestats.evictbytes;
+    evictus = zonestats.evictus;
+  }
+}
+
 void I_GetTime_SaveMS(void)
 {
+  I_TicStats();
+
   if (!movement_smooth)
     return;
 
@@ -151,6 +219,11 @@ void I_GetTime_SaveMS(void)
   tic_vars.step = tic_vars.next - tic_vars.start;
 }
 
+unsigned long I_GetTimeUS(void)
+{
+  return getUsTicks();
+}
+
 unsigned long I_GetRandomTimeSeed(void)
 {
 	return 4; //per https://xkcd.com/221/
@@ -245,6 +318,72 @@ void *I_Mmap(void *addr, size_t length, int prot, int flags, int ifd, off_t offs
     return (byte*)fds[ifd].mmap_ptr + offset;
 }
 
+// Each cache has a partition of its own: a header with the size of the
+// data and the key it was made for, then the data. The magic number goes
+// in last, so a write that didn't finish is never taken for data.
+#define CACHE_MAGIC 0x48434344 // "DCCH"
+#define CACHE_HEADER 1024
+
+typedef struct {
+    uint32_t magic, size;
+} cacheHeader_t;
+
+static const int cacheSubtype[NUMCACHES] = { 8, 9 };
+static const esp_partition_t *cachePart[NUMCACHES];
+static const byte *cacheMap[NUMCACHES];
+static esp_partition_mmap_handle_t cacheHandle[NUMCACHES];
+
+static const esp_partition_t *findCache(datacache_t cache, size_t keysize)
+{
+    if (!cachePart[cache])
+        cachePart[cache] = esp_partition_find_first(66, cacheSubtype[cache], NULL);
+    if (keysize > CACHE_HEADER - sizeof(cacheHeader_t))
+        return NULL;
+    return cachePart[cache];
+}
+
+const void *I_GetCachedData(datacache_t cache, const void *key, size_t keysize, size_t *size)
+{
+    const esp_partition_t *part = findCache(cache, keysize);
+    const cacheHeader_t *hdr;
+
+    if (!part)
+        return NULL;
+    if (!cacheMap[cache] &&
+        esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, (const void **)&cacheMap[cache], &cacheHandle[cache]) != ESP_OK)
+        return NULL;
+    hdr = (const cacheHeader_t *)cacheMap[cache];
+    if (hdr->magic != CACHE_MAGIC || hdr->size > part->size - CACHE_HEADER || memcmp(hdr + 1, key, keysize))
+        return NULL;
+    *size = hdr->size;
+    return cacheMap[cache] + CACHE_HEADER;
+}
+
+const void *I_CacheData(datacache_t cache, const void *key, size_t keysize, const void *data, size_t size)
+{
+    const esp_partition_t *part = findCache(cache, keysize);
+    cacheHeader_t hdr = { CACHE_MAGIC, size };
+
+    if (!part)
+        return NULL;
+    if (size > part->size - CACHE_HEADER)
+    {
+        lprintf(LO_WARN, "I_CacheData: cache %d needs %u bytes, its partition holds %u\n", cache,
+                (unsigned)size, (unsigned)(part->size - CACHE_HEADER));
+        return NULL;
+    }
+    // Writing flushes the flash cache, so a mapping already made shows it
+    if (esp_partition_erase_range(part, 0, (CACHE_HEADER + size + 4095) & ~4095) != ESP_OK ||
+        esp_partition_write(part, CACHE_HEADER, data, size) != ESP_OK ||
+        esp_partition_write(part, sizeof hdr, key, keysize) != ESP_OK ||
+        esp_partition_write(part, 0, &hdr, sizeof hdr) != ESP_OK)
+    {
+        lprintf(LO_WARN, "I_CacheData: writing cache %d failed\n", cache);
+        return NULL;
+    }
+    return I_GetCachedData(cache, key, keysize, &size);
+}
+
 int I_Munmap(void *addr, size_t length) {
     return 0;
 }
@@ -298,3 +437,85 @@ char* I_FindFile(const char* wfname, const char* ext)
 void I_SetAffinityMask(void)
 {
 }
+
+#if defined SPLIT_RENDER || defined PIPELINE_RENDER
+// Plain pthreads, so the two core renderers can be checked against the
+// single threaded one on a host build. IDF maps them onto FreeRTOS tasks.
+
+static pthread_mutex_t renderMux = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t renderCond = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t renderCacheMux;
+static pthread_once_t renderCacheOnce = PTHREAD_ONCE_INIT;
+static void (*renderFunc)(void);
+static int renderPending;
+
+static void *renderThread(void *arg)
+{
+    pthread_mutex_lock(&renderMux);
+    while (1)
+    {
+        while (!renderPending)
+            pthread_cond_wait(&renderCond, &renderMux);
+        pthread_mutex_unlock(&renderMux);
+        renderFunc();
+        pthread_mutex_lock(&renderMux);
+        renderPending = 0;
+        pthread_cond_broadcast(&renderCond);
+    }
+    return NULL;
+}
+
+void I_StartRenderThread(void (*func)(void))
+{
+    pthread_t thread;
+#ifdef ESP_PLATFORM
+    // The doom task owns core 0; the worker shares core 1 with the display
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.stack_size = 16*1024;
+    cfg.prio = 5;
+    cfg.pin_to_core = 1;
+    cfg.thread_name = "render";
+    esp_pthread_set_cfg(&cfg);
+#endif
+    renderFunc = func;
+    if (pthread_create(&thread, NULL, renderThread, NULL))
+        I_Error("I_StartRenderThread: can't create render thread");
+}
+
+void I_SignalRenderThread(void)
+{
+    pthread_mutex_lock(&renderMux);
+    renderPending = 1;
+    pthread_cond_broadcast(&renderCond);
+    pthread_mutex_unlock(&renderMux);
+}
+
+void I_WaitRenderThread(void)
+{
+    pthread_mutex_lock(&renderMux);
+    while (renderPending)
+        pthread_cond_wait(&renderCond, &renderMux);
+    pthread_mutex_unlock(&renderMux);
+}
+
+static void initRenderCacheMux(void)
+{
+    pthread_mutexattr_t attr;
+    // The zone frees cache blocks from inside Z_Malloc
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&renderCacheMux, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void I_LockRenderCache(void)
+{
+    pthread_once(&renderCacheOnce, initRenderCacheMux);
+    pthread_mutex_lock(&renderCacheMux);
+}
+
+void I_UnlockRenderCache(void)
+{
+    pthread_mutex_unlock(&renderCacheMux);
+}
+#endif
@@ -41,6 +41,7 @@
 #include "doomtype.h"
 #include "v_video.h"
 #include "r_draw.h"
+#include "r_main.h"
 #include "d_main.h"
 #include "d_event.h"
 #include "i_video.h"
@@ -50,10 +51,14 @@
 #include "w_wad.h"
 #include "st_stuff.h"
 #include "lprintf.h"
+#include "GAMMATBL.h"
 
 #include "esp_heap_caps.h"
 #include "spi_lcd.h"
-//#include "i80_lcd.h"
+
+#if defined(COLUMN_MAJOR_SCREENS) != defined(LCD_COLUMN_MAJOR)
+#error "COLUMN_MAJOR_SCREENS (config.h) and LCD_COLUMN_MAJOR (spi_lcd.h) go together"
+#endif
 
 
 int use_fullscreen=0;
@@ -108,28 +113,110 @@ void I_EndDisplay(void)
 // I_FinishUpdate
 //
 
+static byte *lastframe;
+static int curpal;
+
+#ifdef PIPELINE_RENDER
+static byte *heldframe;
+static boolean heldframerenewed;
+
+byte *I_GetFreeFrame (void)
+{
+  return spi_lcd_get_free_framebuffer(screens[0].data);
+}
+
+void I_HoldFrame (byte *frame)
+{
+  heldframe = frame;
+  heldframerenewed = true;
+}
+#endif
+
 void I_FinishUpdate (void)
 {
-  spi_lcd_send((uint16_t*)screens[0].data);
-    //i80_lcd_send(screens[0].data);
-	//Flip framebuffers
-//	if (scr==screena) screens[0].data=screenb; else screens[0].data=screena;
+  lastframe = screens[0].data;
+#ifdef PIPELINE_RENDER
+  if (heldframe && !heldframerenewed)
+    R_DropPipelinedFrame();
+  heldframerenewed = false;
+#endif
+  //Flip framebuffers
+  screens[0].data = spi_lcd_flip(lastframe, curpal);
+#ifdef PIPELINE_RENDER
+  // The renderer is still drawing into heldframe
+  if (screens[0].data == heldframe)
+    screens[0].data = spi_lcd_get_free_framebuffer(heldframe);
+#endif
+  if (screens[0].data != lastframe)
+    R_RebaseBuffer();
+}
+
+void I_FinishViewStrip (int y1, int y2, boolean last)
+{
+#ifdef COLUMN_MAJOR_SCREENS
+  // Rows of a column major frame aren't contiguous; they go out with the whole frame
+#else
+  spi_lcd_send_rows(screens[0].data, curpal, y1, y2);
+  if (last)
+    spi_lcd_wait_rows();
+#endif
+}
+
+byte *I_GetLastFrame (void)
+{
+  return lastframe ? lastframe : screens[0].data;
 }
 
-uint16_t lcdpal[256];
+#ifndef LCD_RGB565
+// Every PLAYPAL palette at every gamma level, converted once to the byte-swapped
+// RGB565 the LCD takes. Palette pal at gamma g is entry g*numpals+pal.
+static uint16_t *palbank;
+static int numpals;
 
+static void I_InitPaletteBank(void)
+{
+  int pplump = W_GetNumForName("PLAYPAL");
+  const byte *playpal = W_CacheLumpNum(pplump);
+  const byte *gtable;
+  uint16_t *p;
+
+  numpals = W_LumpLength(pplump) / (3*256);
+  palbank = heap_caps_malloc(5*numpals*256*sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+  assert(palbank);
+  p = palbank;
+  for (int g=0; g<5; g++) {
+    const byte *palette = playpal;
+    gtable = GAMMATBL_dat + 256*g;
+    for (int i=0; i<numpals*256; i++) {
+      int v=((gtable[palette[0]]>>3)<<11)+((gtable[palette[1]]>>2)<<5)+(gtable[palette[2]]>>3);
+      *p++=(v>>8)+(v<<8);
+      palette += 3;
+    }
+  }
+  W_UnlockLumpNum(pplump);
+
+  spi_lcd_set_palettes(palbank, 5*numpals);
+  lprintf(LO_INFO, "I_InitPaletteBank: %d palettes\n", 5*numpals);
+}
+#endif
+
+// Only picks the palette the next finished frame is sent with, so a palette
+// change can't tear a frame the display task is converting.
 void I_SetPalette (int pal)
 {
-	int pplump = W_GetNumForName("PLAYPAL");
-	const byte * palette = W_CacheLumpNum(pplump);
-	palette+=pal*(3*256);
-    for (int i=0; i<255 ; i++) {
-        int v=((palette[0]>>3)<<11)+((palette[1]>>2)<<5)+(palette[2]>>3);
-		lcdpal[i]=(v>>8)+(v<<8);
-//		lcdpal[i]=v;
-		palette += 3;
-	}
-	W_UnlockLumpNum(pplump);
+#ifndef LCD_RGB565
+  // Can be called from the gamma setting before the wads are loaded
+  if (!palbank) {
+    if (W_CheckNumForName("PLAYPAL") < 0)
+      return;
+    I_InitPaletteBank();
+  }
+  if (pal < 0 || pal >= numpals)
+    pal = 0;
+  curpal = usegamma*numpals + pal;
+#endif
+  // With LCD_RGB565 the frames are in their final colours already;
+  // V_SetPalette switches V_Palette16 instead
 }
 
 
@@ -138,7 +225,8 @@ void *screen0;
 void I_PreInitGraphics(void)
 {
 	lprintf(LO_INFO, "preinitgfx");
-    screen0 = heap_caps_malloc(SCREENWIDTH*SCREENHEIGHT, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    // The framebuffers belong to the LCD driver, which flips between them.
+    screen0 = spi_lcd_get_framebuffer();
     assert(screen0);
 }
 
@@ -148,26 +236,36 @@ void I_PreInitGraphics(void)
 // Sets the screen resolution
 void I_SetRes(void)
 {
+#ifdef COLUMN_MAJOR_SCREENS
+  // pitch is the length of a column
+  int pitch = SCREENHEIGHT * V_GetPixelDepth();
+  int stpitch = (ST_SCALED_HEIGHT+1) * V_GetPixelDepth();
+#else
+  int pitch = SCREENPITCH * V_GetPixelDepth();
+  int stpitch = pitch;
+#endif
 //  I_CalculateRes(SCREENWIDTH, SCREENHEIGHT);
 
   // set first three to standard values
   for (int i=0; i<3; i++) {
     screens[i].width = SCREENWIDTH;
     screens[i].height = SCREENHEIGHT;
-    screens[i].byte_pitch = SCREENPITCH;
-    screens[i].short_pitch = SCREENPITCH / V_GetModePixelDepth(VID_MODE16);
-    screens[i].int_pitch = SCREENPITCH / V_GetModePixelDepth(VID_MODE32);
+    screens[i].byte_pitch = pitch;
+    screens[i].short_pitch = pitch / V_GetModePixelDepth(VID_MODE16);
+    screens[i].int_pitch = pitch / V_GetModePixelDepth(VID_MODE32);
   }
 
   // statusbar
   screens[4].width = SCREENWIDTH;
   screens[4].height = (ST_SCALED_HEIGHT+1);
-  screens[4].byte_pitch = SCREENPITCH;
-  screens[4].short_pitch = SCREENPITCH / V_GetModePixelDepth(VID_MODE16);
-  screens[4].int_pitch = SCREENPITCH / V_GetModePixelDepth(VID_MODE32);
+  screens[4].byte_pitch = stpitch;
+  screens[4].short_pitch = stpitch / V_GetModePixelDepth(VID_MODE16);
+  screens[4].int_pitch = stpitch / V_GetModePixelDepth(VID_MODE32);
 
+  // Keep whichever page is current if the mode is changed mid-game
   screens[0].not_on_heap = true;
-  screens[0].data = screen0;
+  if (!screens[0].data)
+    screens[0].data = screen0;
 
 //  spi_lcd_init();
 
@@ -185,6 +283,9 @@ void I_InitGraphics(void)
     atexit(I_ShutdownGraphics);
     lprintf(LO_INFO, "I_InitGraphics: %dx%d\n", SCREENWIDTH, SCREENHEIGHT);
 
+    // Not a user choice here: it tells the engine whether screens[0] survives I_FinishUpdate
+    use_doublebuffer = spi_lcd_framebuffer_count() > 1;
+
     /* Set the video mode */
     I_UpdateVideoMode();
   }
@@ -197,8 +298,12 @@ void I_UpdateVideoMode(void)
 
   lprintf(LO_INFO, "I_UpdateVideoMode: %dx%d\n", SCREENWIDTH, SCREENHEIGHT);
 
-//    mode = VID_MODE16;
-    mode = VID_MODE8;
+  // The framebuffers are in whatever format the LCD driver was built for
+#ifdef LCD_RGB565
+  mode = VID_MODE16;
+#else
+  mode = VID_MODE8;
+#endif
 
   V_InitMode(mode);
   V_DestroyUnusedTrueColorPalettes();
@@ -0,0 +1,22 @@
+#ifndef LCD_CONV_H
+#define LCD_CONV_H
+
+#include <stdint.h>
+
+// Palette expansion kernels: turn 8-bit palette indices into the byte-swapped RGB565 pixels the LCD wants.
+// src is read as 32-bit words holding 4 indices each, lowest byte first; dst must be 4-byte aligned.
+typedef void (*lcd_conv_fn_t)(uint16_t *dst, const uint32_t *src, int nwords);
+
+typedef struct
+{
+    const char *name;
+    // Prepare the kernel for a new 256-entry palette. Returns 0 if the kernel can't be used (out of memory).
+    int (*set_palette)(const uint16_t *pal);
+    lcd_conv_fn_t conv;
+} lcd_conv_kernel_t;
+
+// The first kernel is the plain C reference the others must match bit for bit.
+extern const lcd_conv_kernel_t lcd_conv_kernels[];
+extern const int lcd_conv_kernel_count;
+
+#endif // LCD_CONV_H
@@ -1,8 +1,49 @@
 #ifndef I80_LCD_H
 #define I80_LCD_H
 
+#include <stdint.h>
+
+// Have the engine render in VID_MODE16, straight into byte-swapped RGB565 framebuffers (320x240x2). The display task
+// then only moves pixels, but the framebuffers are twice the size and the renderer writes twice as many bytes.
+//#define LCD_RGB565
+
+// Framebuffers hold the picture column by column; the LCD is put in its native portrait addressing, which takes
+// pixels in that order. Needs COLUMN_MAJOR_SCREENS in the engine's config.h.
+//#define LCD_COLUMN_MAJOR
+
+// Keep four framebuffers instead of three. With PIPELINE_RENDER (config.h) the engine draws into two at once, and with
+// three it has to wait for the display task to take each frame before it can start on the one after.
+//#define LCD_FOUR_FRAMEBUFFERS
+
+typedef struct
+{
+    uint32_t frames;           // frames sent to the LCD
+    uint32_t last_frame_bytes; // SPI bytes (commands + pixels) of the last frame
+    uint32_t last_frame_rects; // dirty rectangles sent in the last frame
+    uint32_t strips;           // row strips sent ahead of their frame
+    uint32_t last_frame_us;    // time the display task spent on the last frame
+    uint64_t total_bytes;
+    uint64_t total_us;
+} spi_lcd_stats_t;
+
 void spi_lcd_wait_finish();
-void spi_lcd_send(uint16_t *scr);
+// Framebuffers (320x240, 8-bit palette indices or RGB565) are owned by the LCD driver. Render into the one returned by
+// spi_lcd_get_framebuffer, then hand it over with spi_lcd_flip, which returns the buffer to render the next frame
+// into. That buffer does not keep its old contents when more than one framebuffer is in use.
+uint8_t *spi_lcd_get_framebuffer();
+uint8_t *spi_lcd_flip(uint8_t *scr, int pal);
+// For a renderer drawing into two framebuffers at once: returns a framebuffer other than inuse that the display task
+// is done with, waiting for one if need be.
+uint8_t *spi_lcd_get_free_framebuffer(const uint8_t *inuse);
+// Hand over rows y1..y2-1 of a framebuffer that is still being drawn into, to be sent ahead of the full frame.
+// The rows must be left alone until spi_lcd_wait_rows returns.
+void spi_lcd_send_rows(uint8_t *scr, int pal, int y1, int y2);
+void spi_lcd_wait_rows();
+// Palettes are given once, as count blocks of 256 byte-swapped RGB565 entries, and must stay valid. Each frame is
+// flipped with the index of the block it should be shown with. Not used with LCD_RGB565.
+void spi_lcd_set_palettes(const uint16_t *pals, int count);
+int spi_lcd_framebuffer_count();
+void spi_lcd_get_stats(spi_lcd_stats_t *stats);
 void spi_lcd_init();
 
 #endif // I80_LCD_H
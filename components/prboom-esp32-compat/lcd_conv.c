@@ -0,0 +1,124 @@
+// Palette expansion kernels for the display task. Plain C without ESP-IDF dependencies (apart from where the pair
+// table lives), so they can be built and compared on a Linux host as well.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lcd_conv.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#else
+#define IRAM_ATTR
+#endif
+
+static uint16_t convPal[256];
+
+static int pal_set_palette(const uint16_t *pal)
+{
+    memcpy(convPal, pal, sizeof(convPal));
+    return 1;
+}
+
+// Reference: one lookup and one 16-bit store per pixel. This is what the display task always did.
+static void IRAM_ATTR conv_ref(uint16_t *dst, const uint32_t *src, int nwords)
+{
+    while (nwords--)
+    {
+        uint32_t d = *src++;
+        dst[0] = convPal[(d >> 0) & 0xff];
+        dst[1] = convPal[(d >> 8) & 0xff];
+        dst[2] = convPal[(d >> 16) & 0xff];
+        dst[3] = convPal[(d >> 24) & 0xff];
+        dst += 4;
+    }
+}
+
+// 16 pixels per iteration. All four source words are loaded up front so the lookups don't wait on each other, and
+// pixels are stored in pairs, halving the number of stores. On the S3 this keeps the load/store unit busy where the
+// PIE vector instructions can't help: they have no table lookup or gather, which is all this loop does.
+static void IRAM_ATTR conv_wide(uint16_t *dst, const uint32_t *src, int nwords)
+{
+    uint32_t *d32 = (uint32_t *)dst;
+
+    for (; nwords >= 4; nwords -= 4)
+    {
+        uint32_t a = src[0], b = src[1], c = src[2], d = src[3];
+        src += 4;
+        d32[0] = convPal[a & 0xff] | ((uint32_t)convPal[(a >> 8) & 0xff] << 16);
+        d32[1] = convPal[(a >> 16) & 0xff] | ((uint32_t)convPal[a >> 24] << 16);
+        d32[2] = convPal[b & 0xff] | ((uint32_t)convPal[(b >> 8) & 0xff] << 16);
+        d32[3] = convPal[(b >> 16) & 0xff] | ((uint32_t)convPal[b >> 24] << 16);
+        d32[4] = convPal[c & 0xff] | ((uint32_t)convPal[(c >> 8) & 0xff] << 16);
+        d32[5] = convPal[(c >> 16) & 0xff] | ((uint32_t)convPal[c >> 24] << 16);
+        d32[6] = convPal[d & 0xff] | ((uint32_t)convPal[(d >> 8) & 0xff] << 16);
+        d32[7] = convPal[(d >> 16) & 0xff] | ((uint32_t)convPal[d >> 24] << 16);
+        d32 += 8;
+    }
+    while (nwords--)
+    {
+        uint32_t a = *src++;
+        d32[0] = convPal[a & 0xff] | ((uint32_t)convPal[(a >> 8) & 0xff] << 16);
+        d32[1] = convPal[(a >> 16) & 0xff] | ((uint32_t)convPal[a >> 24] << 16);
+        d32 += 2;
+    }
+}
+
+// Pair table: 64K entries, each holding the two pixels for a pair of indices, so a 32-bit source word takes two
+// lookups instead of four. 256 KB, so it goes to PSRAM and has to be rebuilt on every palette change.
+static uint32_t *pairTab = NULL;
+
+static int pair_set_palette(const uint16_t *pal)
+{
+    int a, b;
+
+    if (!pairTab)
+    {
+#ifdef ESP_PLATFORM
+        pairTab = heap_caps_malloc(65536 * sizeof(uint32_t), MALLOC_CAP_SPIRAM);
+#else
+        pairTab = malloc(65536 * sizeof(uint32_t));
+#endif
+        if (!pairTab)
+            return 0;
+    }
+    for (b = 0; b < 256; b++)
+    {
+        uint32_t *p = &pairTab[b << 8];
+        uint32_t hi = (uint32_t)pal[b] << 16;
+        for (a = 0; a < 256; a++)
+            p[a] = pal[a] | hi;
+    }
+    return 1;
+}
+
+static void IRAM_ATTR conv_pair(uint16_t *dst, const uint32_t *src, int nwords)
+{
+    uint32_t *d32 = (uint32_t *)dst;
+
+    for (; nwords >= 2; nwords -= 2)
+    {
+        uint32_t a = src[0], b = src[1];
+        src += 2;
+        d32[0] = pairTab[a & 0xffff];
+        d32[1] = pairTab[a >> 16];
+        d32[2] = pairTab[b & 0xffff];
+        d32[3] = pairTab[b >> 16];
+        d32 += 4;
+    }
+    if (nwords)
+    {
+        uint32_t a = *src;
+        d32[0] = pairTab[a & 0xffff];
+        d32[1] = pairTab[a >> 16];
+    }
+}
+
+const lcd_conv_kernel_t lcd_conv_kernels[] = {
+    {"ref", pal_set_palette, conv_ref},
+    {"wide", pal_set_palette, conv_wide},
+    {"pair", pair_set_palette, conv_pair},
+};
+
+const int lcd_conv_kernel_count = sizeof(lcd_conv_kernels) / sizeof(lcd_conv_kernels[0]);
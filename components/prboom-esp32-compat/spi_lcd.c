@@ -13,18 +13,27 @@
 // limitations under the License.
 
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "esp_system.h"
 #include "driver/spi_master.h"
 #include "soc/gpio_struct.h"
 #include "driver/gpio.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 
 #include "sdkconfig.h"
+#include "esp_memory_utils.h"
+#include "config.h"
+#include "lprintf.h"
+
+#include "spi_lcd.h"
+#include "lcd_conv.h"
 
 #define PIN_NUM_MISO CONFIG_LV_DISP_SPI_MISO
 #define PIN_NUM_MOSI CONFIG_LV_DISP_SPI_MOSI
@@ -39,8 +48,16 @@
 #define HW_INV_BL
 #endif
 
-// You want this, especially at higher framerates. The 2nd buffer is allocated in iram anyway, so isn't really in the way.
-#define DOUBLE_BUFFER
+// The renderer draws straight into one of three framebuffers and flips them with the display task, so neither side
+// copies a frame or waits for the other.
+#ifdef LCD_FOUR_FRAMEBUFFERS
+#define NO_FB 4
+#else
+#define NO_FB 3
+#endif
+
+// How many of the framebuffers go in internal RAM is FB_INTERNAL, part of the internal RAM budget in config.h. The
+// rest are in PSRAM.
 
 /*
  The LCD needs a bunch of command/argument values to be initialized. They are stored in this struct.
@@ -65,7 +82,11 @@ static const ili_init_cmd_t ili_init_cmds[] = {
     {0xC1, {0x11}, 1},
     {0xC5, {0x35, 0x3E}, 2},
     {0xC7, {0xBE}, 1},
+#ifdef LCD_COLUMN_MAJOR
+    {0x36, {0x08}, 1},
+#else
     {0x36, {0x28}, 1},
+#endif
     {0x3A, {0x55}, 1},
     {0xB1, {0x00, 0x1B}, 2},
     {0xF2, {0x08}, 1},
@@ -158,6 +179,39 @@ void ili_init(spi_device_handle_t spi)
     }
 }
 
+// Framebuffer geometry. A column major framebuffer is the landscape picture as 320 lines of 240 pixels, which with
+// MADCTL MV cleared is exactly how the controller's columns (CASET) and pages (PASET) run. Everything below works
+// on framebuffer lines, so dirty rectangles, windows and strips follow along.
+#ifdef LCD_COLUMN_MAJOR
+#define LCD_WIDTH 240
+#define LCD_HEIGHT 320
+#else
+#define LCD_WIDTH 320
+#define LCD_HEIGHT 240
+#endif
+#ifdef LCD_RGB565
+#define LCD_BPP 2
+#else
+#define LCD_BPP 1
+#endif
+#define LCD_FB_SIZE (LCD_WIDTH * LCD_HEIGHT * LCD_BPP)
+#define LCD_WORDS_PER_ROW (LCD_WIDTH * LCD_BPP / 4)
+#define LCD_PIX_PER_WORD (4 / LCD_BPP)
+
+// Print the display task's averages every this many frames
+#define STATS_INTERVAL 512
+
+static spi_lcd_stats_t lcdStats;
+static uint32_t frameBytes = 0;
+
+// All LCD traffic of a frame goes through here so the bytes on the bus can be counted. This is also the one place
+// a host build needs to stub out to measure it.
+static esp_err_t lcd_queue_trans(spi_device_handle_t spi, spi_transaction_t *t)
+{
+    frameBytes += t->length / 8;
+    return spi_device_queue_trans(spi, t, portMAX_DELAY);
+}
+
 static void send_header_start(spi_device_handle_t spi, int xpos, int ypos, int w, int h)
 {
     esp_err_t ret;
@@ -200,7 +254,7 @@ static void send_header_start(spi_device_handle_t spi, int xpos, int ypos, int w
     // Queue all transactions.
     for (x = 0; x < 5; x++)
     {
-        ret = spi_device_queue_trans(spi, &trans[x], portMAX_DELAY);
+        ret = lcd_queue_trans(spi, &trans[x]);
         assert(ret == ESP_OK);
     }
 
@@ -223,29 +277,300 @@ void send_header_cleanup(spi_device_handle_t spi)
     }
 }
 
-#ifndef DOUBLE_BUFFER
-volatile static uint16_t *currFbPtr = NULL;
-#else
-// Warning: This gets squeezed into IRAM.
-static uint32_t *currFbPtr = NULL;
-#endif
+// At any time one buffer is being rendered into, at most one is the newest finished frame waiting for the display
+// task (fbReady) and at most one is being read by it (fbDisplaying). The rest are free for the renderer to take.
+static uint8_t *fb[NO_FB];
+static int fbPal[NO_FB];
+static int fbReady = -1;
+static int fbDisplaying = -1;
+static portMUX_TYPE fbMux = portMUX_INITIALIZER_UNLOCKED;
 SemaphoreHandle_t dispSem = NULL;
-SemaphoreHandle_t dispDoneSem = NULL;
+
+// Row strips handed over by spi_lcd_send_rows, sent before the frame they belong to.
+typedef struct
+{
+    const uint8_t *scr;
+    int pal;
+    int y1, y2;
+} lcd_strip_t;
+
+#define NO_STRIPS 8
+static QueueHandle_t stripQueue = NULL;
+static SemaphoreHandle_t stripDoneSem = NULL;
+static volatile int stripsPending = 0;
+static portMUX_TYPE stripMux = portMUX_INITIALIZER_UNLOCKED;
 
 #define NO_SIM_TRANS 5         // Amount of SPI transfers to queue in parallel
 #define MEM_PER_TRANS 1024 * 3 // in 16-bit words
 
-extern int16_t lcdpal[256];
+// Runs of changed rows closer than this are merged into one rectangle; re-sending a few unchanged rows is cheaper
+// than the 5 transactions needed to set up another CASET/PASET window.
+#define DIRTY_MERGE_ROWS 4
+#define MAX_DIRTY_RECTS 16
 
-void IRAM_ATTR displayTask(void *arg)
+typedef struct
+{
+    int x, y, w, h; // x and w are multiples of LCD_PIX_PER_WORD pixels
+} dirty_rect_t;
+
+static uint16_t *dmamem[NO_SIM_TRANS];
+static spi_transaction_t trans[NO_SIM_TRANS];
+static int dmaIdx = 0;
+static int inProgress = 0;
+
+// What is currently on the glass, as framebuffer pixels plus the palette they were converted with. New frames are
+// diffed against it, and changed rows are copied in here before being sent, so it never gets out of sync with the LCD.
+static uint32_t *lastFb = NULL;
+static int lastPal = -1;
+static int forceFull = 1;
+
+// Palettes as set by spi_lcd_set_palettes; each frame comes with an index into these.
+static const uint16_t *palBank = NULL;
+static int palCount = 0;
+
+static dirty_rect_t dirtyRects[MAX_DIRTY_RECTS];
+
+#ifndef LCD_RGB565
+// Palette expansion kernel, picked by select_conv_kernel at startup.
+static const lcd_conv_kernel_t *conv = &lcd_conv_kernels[0];
+#endif
+
+// Queue the first len pixels of the current DMA buffer and move on to the next one.
+static void IRAM_ATTR queue_pixels(int len)
 {
-    int x, i;
-    int idx = 0;
-    int inProgress = 0;
-    static uint16_t *dmamem[NO_SIM_TRANS];
-    spi_transaction_t trans[NO_SIM_TRANS];
+    esp_err_t ret;
     spi_transaction_t *rtrans;
 
+    trans[dmaIdx].length = len * 16;
+    trans[dmaIdx].user = (void *)1;
+    trans[dmaIdx].tx_buffer = dmamem[dmaIdx];
+    ret = lcd_queue_trans(spi, &trans[dmaIdx]);
+    assert(ret == ESP_OK);
+
+    dmaIdx++;
+    if (dmaIdx >= NO_SIM_TRANS)
+        dmaIdx = 0;
+
+    if (inProgress == NO_SIM_TRANS - 1)
+    {
+        ret = spi_device_get_trans_result(spi, &rtrans, portMAX_DELAY);
+        assert(ret == ESP_OK);
+    }
+    else
+    {
+        inProgress++;
+    }
+}
+
+static void IRAM_ATTR wait_pixels_done(void)
+{
+    esp_err_t ret;
+    spi_transaction_t *rtrans;
+
+    while (inProgress)
+    {
+        ret = spi_device_get_trans_result(spi, &rtrans, portMAX_DELAY);
+        assert(ret == ESP_OK);
+        inProgress--;
+    }
+}
+
+// Diff rows y1..y2-1 of a new frame against lastFb and fill dirtyRects with the areas that need to be re-sent.
+// Changed words are copied into lastFb on the way. Returns the number of rectangles.
+static int IRAM_ATTR find_dirty_rects(const uint32_t *src, int pal, int y1, int y2)
+{
+    int y, x0, x1;
+    int n = 0;
+    int area = 0;
+    int lastDirtyRow = 0;
+    dirty_rect_t *r = NULL;
+
+    // A palette change touches every pixel on screen. Only ever the case for whole frames.
+    if (forceFull || pal != lastPal)
+    {
+        memcpy(lastFb, src, LCD_FB_SIZE);
+        lastPal = pal;
+#ifndef LCD_RGB565
+        static const uint16_t blackPal[256];
+        const uint16_t *p = (palBank && pal >= 0 && pal < palCount) ? &palBank[pal * 256] : blackPal;
+
+        if (!conv->set_palette(p))
+        {
+            conv = &lcd_conv_kernels[0];
+            conv->set_palette(p);
+        }
+#endif
+        forceFull = 0;
+        goto full;
+    }
+
+    for (y = y1; y < y2; y++)
+    {
+        const uint32_t *s = src + y * LCD_WORDS_PER_ROW;
+        uint32_t *d = lastFb + y * LCD_WORDS_PER_ROW;
+
+        for (x0 = 0; x0 < LCD_WORDS_PER_ROW && s[x0] == d[x0]; x0++)
+            ;
+        if (x0 == LCD_WORDS_PER_ROW)
+            continue;
+        for (x1 = LCD_WORDS_PER_ROW; s[x1 - 1] == d[x1 - 1]; x1--)
+            ;
+        memcpy(&d[x0], &s[x0], (x1 - x0) * 4);
+        x0 *= LCD_PIX_PER_WORD;
+        x1 *= LCD_PIX_PER_WORD;
+
+        if (r && (y - lastDirtyRow <= DIRTY_MERGE_ROWS + 1 || n == MAX_DIRTY_RECTS))
+        {
+            int rx1 = r->x + r->w;
+            if (x0 < r->x)
+                r->x = x0;
+            if (x1 > rx1)
+                rx1 = x1;
+            r->w = rx1 - r->x;
+            r->h = y + 1 - r->y;
+        }
+        else
+        {
+            r = &dirtyRects[n++];
+            r->x = x0;
+            r->y = y;
+            r->w = x1 - x0;
+            r->h = 1;
+        }
+        lastDirtyRow = y;
+    }
+
+    for (y = 0; y < n; y++)
+        area += dirtyRects[y].w * dirtyRects[y].h;
+    // Mostly changed anyway; one window is cheaper than several.
+    if (area > LCD_WIDTH * (y2 - y1) * 3 / 4)
+        goto full;
+    return n;
+
+full:
+    dirtyRects[0].x = 0;
+    dirtyRects[0].y = y1;
+    dirtyRects[0].w = LCD_WIDTH;
+    dirtyRects[0].h = y2 - y1;
+    return 1;
+}
+
+// Convert one rectangle of lastFb to RGB565 and push it out through the DMA buffers. With LCD_RGB565 the pixels are
+// already what the LCD wants and are only copied into DMA-capable memory.
+static void IRAM_ATTR send_rect(const dirty_rect_t *r)
+{
+    int y, n, words;
+    int fill = 0;
+    int rows = r->h;
+    int rowWords = r->w / LCD_PIX_PER_WORD;
+
+    // Full-width rows are contiguous in lastFb; convert them as one long row.
+    if (r->w == LCD_WIDTH)
+    {
+        rowWords *= rows;
+        rows = 1;
+    }
+
+    send_header_start(spi, r->x, r->y, r->w, r->h);
+    send_header_cleanup(spi);
+    for (y = r->y; y < r->y + rows; y++)
+    {
+        const uint32_t *s = lastFb + y * LCD_WORDS_PER_ROW + r->x / LCD_PIX_PER_WORD;
+        for (words = rowWords; words; words -= n)
+        {
+            n = (MEM_PER_TRANS - fill) / LCD_PIX_PER_WORD;
+            if (n > words)
+                n = words;
+#ifdef LCD_RGB565
+            memcpy(&dmamem[dmaIdx][fill], s, n * 4);
+#else
+            conv->conv(&dmamem[dmaIdx][fill], s, n);
+#endif
+            s += n;
+            fill += n * LCD_PIX_PER_WORD;
+            if (fill == MEM_PER_TRANS)
+            {
+                queue_pixels(fill);
+                fill = 0;
+            }
+        }
+    }
+    if (fill)
+        queue_pixels(fill);
+    // The next window's header transactions must not be interleaved with these results.
+    wait_pixels_done();
+}
+
+#ifndef LCD_RGB565
+// Time every palette expansion kernel on a full frame of noise and use the fastest one that produces exactly the
+// same pixels as the reference. A palette change always means a full frame, so what counts is a palette set plus a
+// full frame: the pain and pickup flashes change it every few tics, and a kernel that is quick to convert but slow
+// to set up would stall exactly those frames. Uses lastFb and the DMA buffers as scratch, before the first frame
+// arrives.
+static void select_conv_kernel(void)
+{
+    int k, x, n;
+    int64_t t, tpal, best = INT64_MAX;
+    uint32_t seed = 1;
+    static uint16_t testPal[256];
+
+    for (x = 0; x < LCD_WIDTH * LCD_HEIGHT / 4; x++)
+    {
+        seed = seed * 1103515245 + 12345;
+        lastFb[x] = seed;
+    }
+    for (x = 0; x < 256; x++)
+        testPal[x] = (x * 0x9E37) ^ (x << 3);
+
+    for (k = 0; k < lcd_conv_kernel_count; k++)
+    {
+        const lcd_conv_kernel_t *kern = &lcd_conv_kernels[k];
+        int ok = 1;
+
+        tpal = esp_timer_get_time();
+        if (!kern->set_palette(testPal))
+        {
+            printf("spi_lcd: conversion kernel %s unavailable\n", kern->name);
+            continue;
+        }
+        t = esp_timer_get_time();
+        tpal = t - tpal;
+        for (x = 0; x < LCD_WIDTH * LCD_HEIGHT / 4; x += MEM_PER_TRANS / 4)
+            kern->conv(dmamem[0], lastFb + x, MEM_PER_TRANS / 4);
+        t = esp_timer_get_time() - t;
+
+        // Check against the reference, chunk by chunk.
+        for (x = 0; x < LCD_WIDTH * LCD_HEIGHT / 4 && ok; x += MEM_PER_TRANS / 4)
+        {
+            kern->conv(dmamem[0], lastFb + x, MEM_PER_TRANS / 4);
+            for (n = 0; n < MEM_PER_TRANS; n++)
+            {
+                uint32_t d = lastFb[x + n / 4];
+                if (dmamem[0][n] != testPal[(d >> ((n & 3) * 8)) & 0xff])
+                {
+                    ok = 0;
+                    break;
+                }
+            }
+        }
+        printf("spi_lcd: conversion kernel %s: %lld us/frame, %lld us/palette%s\n", kern->name, (long long)t,
+               (long long)tpal, ok ? "" : ", MISMATCH");
+        if (ok && t + tpal < best)
+        {
+            best = t + tpal;
+            conv = kern;
+        }
+    }
+    printf("spi_lcd: using conversion kernel %s\n", conv->name);
+    // Palette and lastFb are garbage now; the first real frame is sent in full.
+    forceFull = 1;
+}
+#endif
+
+void IRAM_ATTR displayTask(void *arg)
+{
+    int x, n;
+
     esp_err_t ret;
     spi_bus_config_t buscfg = {
         .miso_io_num = PIN_NUM_MISO,
@@ -281,96 +606,176 @@ void IRAM_ATTR displayTask(void *arg)
         memset(&trans[x], 0, sizeof(spi_transaction_t));
         trans[x].length = MEM_PER_TRANS * 2;
         trans[x].user = (void *)1;
-        trans[x].tx_buffer = &dmamem[x];
+        trans[x].tx_buffer = dmamem[x];
     }
-    xSemaphoreGive(dispDoneSem);
+#ifdef LCD_RGB565
+    printf("spi_lcd: RGB565 framebuffers, no conversion\n");
+#else
+    select_conv_kernel();
+#endif
 
     while (1)
     {
+        lcd_strip_t strip;
+        int64_t t;
+
         xSemaphoreTake(dispSem, portMAX_DELAY);
+        t = esp_timer_get_time();
 //		printf("Display task: frame.\n");
-#ifndef DOUBLE_BUFFER
-        uint8_t *myData = (uint8_t *)currFbPtr;
-#endif
+        while (xQueueReceive(stripQueue, &strip, 0) == pdTRUE)
+        {
+            // Needs a full frame for a new palette; the rows then simply go out with it.
+            n = 0;
+            if (!forceFull && strip.pal == lastPal)
+                n = find_dirty_rects((const uint32_t *)strip.scr, strip.pal, strip.y1, strip.y2);
+            portENTER_CRITICAL(&stripMux);
+            stripsPending--;
+            portEXIT_CRITICAL(&stripMux);
+            xSemaphoreGive(stripDoneSem);
+            for (x = 0; x < n; x++)
+                send_rect(&dirtyRects[x]);
+            lcdStats.strips++;
+        }
 
-        send_header_start(spi, 0, 0, 320, 240);
-        send_header_cleanup(spi);
-        for (x = 0; x < 320 * 240; x += MEM_PER_TRANS)
+        portENTER_CRITICAL(&fbMux);
+        fbDisplaying = fbReady;
+        fbReady = -1;
+        portEXIT_CRITICAL(&fbMux);
+        if (fbDisplaying < 0)
+            continue;
+        n = find_dirty_rects((const uint32_t *)fb[fbDisplaying], fbPal[fbDisplaying], 0, LCD_HEIGHT);
+        // Everything that changed has been copied to lastFb already; the renderer may have the buffer back.
+        portENTER_CRITICAL(&fbMux);
+        fbDisplaying = -1;
+        portEXIT_CRITICAL(&fbMux);
+        for (x = 0; x < n; x++)
+            send_rect(&dirtyRects[x]);
+
+        t = esp_timer_get_time() - t;
+        lcdStats.frames++;
+        lcdStats.last_frame_bytes = frameBytes;
+        lcdStats.last_frame_rects = n;
+        lcdStats.last_frame_us = t;
+        lcdStats.total_bytes += frameBytes;
+        lcdStats.total_us += t;
+        frameBytes = 0;
+        if (lcdStats.frames % STATS_INTERVAL == 0)
+            printf("spi_lcd: %d bpp, %lld us and %lld bytes per frame\n", LCD_BPP * 8,
+                   (long long)(lcdStats.total_us / lcdStats.frames), (long long)(lcdStats.total_bytes / lcdStats.frames));
+    }
+}
+
+void spi_lcd_wait_finish()
+{
+    // Nothing to wait for: spi_lcd_flip always hands back a buffer the display task isn't reading
+}
+
+uint8_t *spi_lcd_get_framebuffer()
+{
+    return fb[0];
+}
+
+void spi_lcd_send_rows(uint8_t *scr, int pal, int y1, int y2)
+{
+    lcd_strip_t strip = {scr, pal, y1, y2};
+
+    portENTER_CRITICAL(&stripMux);
+    stripsPending++;
+    portEXIT_CRITICAL(&stripMux);
+    xQueueSend(stripQueue, &strip, portMAX_DELAY);
+    xSemaphoreGive(dispSem);
+}
+
+void spi_lcd_wait_rows()
+{
+    while (stripsPending)
+        xSemaphoreTake(stripDoneSem, portMAX_DELAY);
+}
+
+void spi_lcd_set_palettes(const uint16_t *pals, int count)
+{
+    palBank = pals;
+    palCount = count;
+}
+
+uint8_t *spi_lcd_flip(uint8_t *scr, int pal)
+{
+    int i, done = 0, next = 0;
+
+    for (i = 0; i < NO_FB; i++)
+        if (fb[i] == scr)
+            done = i;
+
+    // A finished frame the display task hasn't picked up yet is simply replaced; its buffer becomes free again.
+    portENTER_CRITICAL(&fbMux);
+    fbPal[done] = pal;
+    fbReady = done;
+    for (i = 0; i < NO_FB; i++)
+    {
+        if (i != fbReady && i != fbDisplaying)
         {
-#ifdef DOUBLE_BUFFER
-            for (i = 0; i < MEM_PER_TRANS; i += 4)
-            {
-                uint32_t d = currFbPtr[(x + i) / 4];
-                dmamem[idx][i + 0] = lcdpal[(d >> 0) & 0xff];
-                dmamem[idx][i + 1] = lcdpal[(d >> 8) & 0xff];
-                dmamem[idx][i + 2] = lcdpal[(d >> 16) & 0xff];
-                dmamem[idx][i + 3] = lcdpal[(d >> 24) & 0xff];
-            }
-#else
-            for (i = 0; i < MEM_PER_TRANS; i++)
-            {
-                dmamem[idx][i] = lcdpal[myData[i]];
-            }
-            myData += MEM_PER_TRANS;
-#endif
-            trans[idx].length = MEM_PER_TRANS * 16;
-            trans[idx].user = (void *)1;
-            trans[idx].tx_buffer = dmamem[idx];
-            ret = spi_device_queue_trans(spi, &trans[idx], portMAX_DELAY);
-            assert(ret == ESP_OK);
+            next = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&fbMux);
+    xSemaphoreGive(dispSem);
+    return fb[next];
+}
 
-            idx++;
-            if (idx >= NO_SIM_TRANS)
-                idx = 0;
+uint8_t *spi_lcd_get_free_framebuffer(const uint8_t *inuse)
+{
+    int i, next;
 
-            if (inProgress == NO_SIM_TRANS - 1)
-            {
-                ret = spi_device_get_trans_result(spi, &rtrans, portMAX_DELAY);
-                assert(ret == ESP_OK);
-            }
-            else
+    while (1)
+    {
+        next = -1;
+        portENTER_CRITICAL(&fbMux);
+        for (i = 0; i < NO_FB; i++)
+        {
+            if (i != fbReady && i != fbDisplaying && fb[i] != inuse)
             {
-                inProgress++;
+                next = i;
+                break;
             }
         }
-#ifndef DOUBLE_BUFFER
-        xSemaphoreGive(dispDoneSem);
-#endif
-        while (inProgress)
-        {
-            ret = spi_device_get_trans_result(spi, &rtrans, portMAX_DELAY);
-            assert(ret == ESP_OK);
-            inProgress--;
-        }
+        portEXIT_CRITICAL(&fbMux);
+        if (next >= 0)
+            return fb[next];
+        // Every other buffer is waiting for, or being read by, the display task
+        vTaskDelay(1);
     }
 }
 
-void spi_lcd_wait_finish()
+int spi_lcd_framebuffer_count()
 {
-#ifndef DOUBLE_BUFFER
-    xSemaphoreTake(dispDoneSem, portMAX_DELAY);
-#endif
+    return NO_FB;
 }
 
-void spi_lcd_send(uint16_t *scr)
+void spi_lcd_get_stats(spi_lcd_stats_t *stats)
 {
-#ifdef DOUBLE_BUFFER
-    memcpy(currFbPtr, scr, 320 * 240);
-    // Theoretically, also should double-buffer the lcdpal array... ahwell.
-#else
-    currFbPtr = scr;
-#endif
-    xSemaphoreGive(dispSem);
+    *stats = lcdStats;
 }
 
 void spi_lcd_init()
 {
     printf("spi_lcd_init()\n");
     dispSem = xSemaphoreCreateBinary();
-    dispDoneSem = xSemaphoreCreateBinary();
-#ifdef DOUBLE_BUFFER
-    currFbPtr = heap_caps_malloc(320 * 240, /*MALLOC_CAP_32BIT*/ MALLOC_CAP_SPIRAM);
-#endif
+    stripDoneSem = xSemaphoreCreateBinary();
+    stripQueue = xQueueCreate(NO_STRIPS, sizeof(lcd_strip_t));
+    // The renderer is a lot faster drawing into internal RAM, but every framebuffer there is internal RAM the zone,
+    // thinker slabs and hot lumps can't have. Only FB_INTERNAL of them are, as far as they fit.
+    for (int i = 0; i < NO_FB; i++)
+    {
+        fb[i] = i < FB_INTERNAL ? heap_caps_malloc(LCD_FB_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) : NULL;
+        if (!fb[i])
+            fb[i] = heap_caps_malloc(LCD_FB_SIZE, MALLOC_CAP_SPIRAM);
+        assert(fb[i]);
+        lprintf(LO_INFO, "spi_lcd_init: framebuffer %d in %s\n", i,
+                esp_ptr_internal(fb[i]) ? "internal RAM" : "PSRAM");
+    }
+    lastFb = heap_caps_malloc(LCD_FB_SIZE, MALLOC_CAP_SPIRAM);
+    assert(lastFb);
 #if CONFIG_FREERTOS_UNICORE
     xTaskCreatePinnedToCore(&displayTask, "display", 6000, NULL, 6, NULL, 0);
 #else
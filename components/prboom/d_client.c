@@ -83,7 +83,7 @@ static int xtratics = 0;
 int              wanted_player_number;
 
 //ToDo: What is this? - JD
-int ms_to_next_tick;
+int ms_to_next_tick, us_to_next_tick;
 
 static boolean isExtraDDisplay = false;
 
@@ -471,13 +471,21 @@ void TryRunTics (void)
 #endif
     runtics = (server ? remotetic : maketic) - gametic;
     if (!runtics) {
-      if (!movement_smooth) {
+      // Frame pacing: draw an in-between frame only if it should be done
+      // before the next tic is due, else sleep up to the tic so it isn't
+      // started late
+      boolean extraframe = (V_GetMode() == VID_MODEGL ?
+        movement_smooth :
+        movement_smooth && gamestate==wipegamestate) &&
+        (unsigned long)us_to_next_tick > displaycost;
+
+      if (!extraframe) {
 #ifdef HAVE_NET
         if (server)
           I_WaitForPacket(ms_to_next_tick);
         else
 #endif
-          I_uSleep(ms_to_next_tick*1000);
+          I_uSleep(us_to_next_tick);
       }
       if (I_GetTime() - entertime > 10) {
 #ifdef HAVE_NET
@@ -491,17 +499,12 @@ void TryRunTics (void)
 #endif
         M_Ticker(); return;
       }
-      //if ((displaytime) < (tic_vars.next-SDL_GetTicks()))
+      if (extraframe)
       {
         WasRenderedInTryRunTics = true;
-        if (V_GetMode() == VID_MODEGL ? 
-            movement_smooth : 
-            movement_smooth && gamestate==wipegamestate)
-        {
-          isExtraDDisplay = true;
-          D_Display();
-          isExtraDDisplay = false;
-        }
+        isExtraDDisplay = true;
+        D_Display();
+        isExtraDDisplay = false;
       }
     } else break;
   }
@@ -80,6 +80,7 @@
 #include "r_fps.h"
 #include "d_main.h"
 #include "d_deh.h"  // Ty 04/08/98 - Externalizations
+#include "d_snapshot.h"
 #include "lprintf.h"  // jff 08/03/98 - declaration of lprintf
 #include "am_map.h"
 
@@ -202,6 +203,10 @@ gamestate_t    wipegamestate = GS_DEMOSCREEN;
 extern boolean setsizeneeded;
 extern int     showMessages;
 
+// Time D_Display takes, in microseconds. Follows a slower frame at once
+// and a faster one slowly, so TryRunTics errs on the side of the tic.
+unsigned long displaycost;
+
 void D_Display (void)
 {
   static boolean inhelpscreensstate   = false;
@@ -210,6 +215,7 @@ void D_Display (void)
   static gamestate_t oldgamestate = -1;
   boolean wipe;
   boolean viewactive = false, isborder = false;
+  unsigned long t2d, t3d = 0;
 
   if (nodrawers)                    // for comparative timing / profiling
     return;
@@ -217,6 +223,8 @@ void D_Display (void)
   if (!I_StartDisplay())
     return;
 
+  t2d = I_GetTimeUS();
+
   // save the current screen if about to wipe
   if ((wipe = gamestate != wipegamestate) && (V_GetMode() != VID_MODEGL))
     wipe_StartScreen();
@@ -269,12 +277,16 @@ void D_Display (void)
       // and there is a menu being displayed
       borderwillneedredraw = menuactive && isborder && viewactive && (viewwidth != SCREENWIDTH);
     }
-    if (redrawborderstuff || (V_GetMode() == VID_MODEGL))
+    // With page flipping screens[0] holds an older frame, so the border has to go in every time
+    if (redrawborderstuff || (V_GetMode() == VID_MODEGL) || use_doublebuffer)
       R_DrawViewBorder();
 
     // Now do the drawing
-    if (viewactive)
+    if (viewactive) {
+      t3d = I_GetTimeUS();
       R_RenderPlayerView (&players[displayplayer]);
+      t3d = I_GetTimeUS() - t3d;
+    }
     if (automapmode & am_active)
       AM_Drawer();
     ST_Drawer((viewheight != SCREENHEIGHT) || ((automapmode & am_active) && !(automapmode & am_overlay)), redrawborderstuff);
@@ -296,6 +308,8 @@ void D_Display (void)
 
   // menus go directly to the screen
   M_Drawer();          // menu is drawn even on top of everything
+  // everything but the 3D view, for rendering_stats
+  rendered_2dtime = I_GetTimeUS() - t2d - t3d;
 #ifdef HAVE_NET
   NetUpdate();         // send out any new accumulation
 #else
@@ -313,6 +327,12 @@ void D_Display (void)
 
   I_EndDisplay();
 
+  t2d = I_GetTimeUS() - t2d;
+  if (t2d > displaycost)
+    displaycost = t2d;
+  else
+    displaycost -= (displaycost - t2d) / 16;
+
   //e6y: don't thrash cpu during pausing
   if (paused) {
     I_uSleep(1000);
@@ -1557,6 +1577,7 @@ static void D_DoomMainSetup(void)
   //jff 9/3/98 use logical output routine
   lprintf(LO_INFO,"\nP_Init: Init Playloop state.\n");
   P_Init();
+  D_SaveSnapshot();
 
   //jff 9/3/98 use logical output routine
   lprintf(LO_INFO,"I_Init: Setting up machine state.\n");
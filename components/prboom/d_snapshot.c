@@ -0,0 +1,289 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2000 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *      Warm boot snapshot of the tables built from the wads.
+ *
+ *      The lump directory W_Init sorts, the texture
+ *      definitions R_InitTextures parses and the sprite frames
+ *      R_InitSpriteDefs collects go into one blob, saved as
+ *      cache_snapshot after a boot that had to build them. Later
+ *      boots read the textures and sprite frames in place from it.
+ *
+ *      The blob holds no pointers: lumps keep their wad as an index
+ *      into wadfiles, and everything else is found by offsets from its
+ *      start. It is saved under an MD5 of the wad directories as they
+ *      are read, so a changed wad fails the lookup and the tables are
+ *      built as before. Hashing the wads whole would take longer than
+ *      the snapshot saves.
+ *
+ *      Only the engine on the device writes the blob. There is no host
+ *      tool to build it from wad files: texture_t and spriteframe_t are
+ *      kept in the target's own layout, sizes and padding included,
+ *      because they are used in place from flash, and a host compiler
+ *      lays them out differently. The key covers their sizes, so a blob
+ *      from another build is never used. It is only rebuilt.
+ *
+ *-----------------------------------------------------------------------------
+ */
+
+#include <string.h>
+
+#include "doomstat.h"
+#include "d_snapshot.h"
+#include "w_wad.h"
+#include "r_data.h"
+#include "r_state.h"
+#include "info.h"
+#include "i_system.h"
+#include "z_zone.h"
+#include "md5.h"
+#include "lprintf.h"
+
+// Bump when the layout of anything below, texture_t or spriteframe_t changes
+#define SNAPSHOT_VERSION 2
+
+// Packed, as doom2.wad has nearly 3000 lumps and the whole blob has to
+// fit the snapshot partition. The hash chains aren't kept; W_HashLumps
+// rebuilds them.
+typedef struct {
+  char name[8];
+  int size, position;
+  short wadfile;              // index into wadfiles, -1 for none
+  byte li_namespace, source;
+} snaplump_t;
+
+typedef struct {
+  int numframes, frames;      // spriteframe_t[numframes] at frames
+} snapsprite_t;
+
+typedef struct {
+  int numlumps, lumps;        // snaplump_t[numlumps]
+  int numtextures, textures;  // int[numtextures], offsets of each texture_t
+  int numsprites, spritenames, sprites; // char[numsprites][4], snapsprite_t[numsprites]
+} snapshot_t;
+
+static unsigned char key[16];
+static const snapshot_t *snapshot;
+static boolean rebuilt;       // some table was built, not read
+static unsigned long starttime;
+
+static void D_PackLump(snaplump_t *l, const lumpinfo_t *lump)
+{
+  memset(l, 0, sizeof *l);
+  memcpy(l->name, lump->name, sizeof l->name);
+  l->size = lump->size;
+  l->li_namespace = lump->li_namespace;
+  l->wadfile = lump->wadfile ? lump->wadfile - wadfiles : -1;
+  l->position = lump->position;
+  l->source = lump->source;
+}
+
+#define SNAPSHOT_AT(ofs) ((const byte *)snapshot + (ofs))
+
+//
+// D_SnapshotLumps
+// Called by W_Init with the wad directories as they were read, before
+// they are sorted
+//
+
+boolean D_SnapshotLumps(void)
+{
+  struct MD5Context md5;
+  int layout[4] = { SNAPSHOT_VERSION, sizeof(snaplump_t), sizeof(texture_t), sizeof(spriteframe_t) };
+  const snaplump_t *l;
+  size_t size;
+  int i;
+
+  starttime = I_GetTimeUS();
+
+  MD5Init(&md5);
+  MD5Update(&md5, (const md5byte *)layout, sizeof layout);
+  for (i=0; i<numlumps; i++)
+    {
+      snaplump_t raw;
+      D_PackLump(&raw, &lumpinfo[i]);
+      MD5Update(&md5, (const md5byte *)&raw, sizeof raw);
+    }
+  MD5Final(key, &md5);
+
+  snapshot = I_GetCachedData(cache_snapshot, key, sizeof key, &size);
+  if (!snapshot || size < sizeof *snapshot)
+    {
+      snapshot = NULL;
+      rebuilt = true;
+      return false;
+    }
+
+  numlumps = snapshot->numlumps;
+  lumpinfo = realloc(lumpinfo, numlumps*sizeof(lumpinfo_t));
+  l = (const snaplump_t *)SNAPSHOT_AT(snapshot->lumps);
+  for (i=0; i<numlumps; i++, l++)
+    {
+      lumpinfo_t *lump = &lumpinfo[i];
+      memcpy(lump->name, l->name, sizeof l->name);
+      lump->name[8] = 0;
+      lump->size = l->size;
+      lump->li_namespace = l->li_namespace;
+      lump->wadfile = l->wadfile >= 0 ? &wadfiles[l->wadfile] : NULL;
+      lump->position = l->position;
+      lump->source = l->source;
+    }
+  return true;
+}
+
+//
+// D_SnapshotTextures
+// The textures are used in place; nothing changes them once they are set up
+//
+
+boolean D_SnapshotTextures(void)
+{
+  const int *ofs;
+  int i;
+
+  if (!snapshot)
+    return false;
+
+  numtextures = snapshot->numtextures;
+  textures = Z_Malloc(numtextures*sizeof*textures, PU_STATIC, 0);
+  ofs = (const int *)SNAPSHOT_AT(snapshot->textures);
+  for (i=0; i<numtextures; i++)
+    textures[i] = (texture_t *)SNAPSHOT_AT(ofs[i]);
+  return true;
+}
+
+//
+// D_SnapshotSprites
+// Dehacked can rename sprites, so the names have to match as well
+//
+
+boolean D_SnapshotSprites(const char * const *namelist)
+{
+  const char *names;
+  const snapsprite_t *s;
+  int i;
+
+  if (!snapshot)
+    return false;
+
+  names = (const char *)SNAPSHOT_AT(snapshot->spritenames);
+  for (i=0; i<snapshot->numsprites; i++)
+    if (!namelist[i] || strncmp(namelist[i], names + i*4, 4))
+      break;
+  if (i < snapshot->numsprites || namelist[i])
+    {
+      rebuilt = true;
+      return false;
+    }
+
+  numsprites = snapshot->numsprites;
+  sprites = Z_Malloc(numsprites*sizeof(*sprites), PU_STATIC, NULL);
+  s = (const snapsprite_t *)SNAPSHOT_AT(snapshot->sprites);
+  for (i=0; i<numsprites; i++, s++)
+    {
+      sprites[i].numframes = s->numframes;
+      sprites[i].spriteframes = s->numframes ?
+        (spriteframe_t *)SNAPSHOT_AT(s->frames) : NULL;
+    }
+  return true;
+}
+
+//
+// D_SaveSnapshot
+// Called by D_DoomMainSetup once the sprites are set up. The blob is laid
+// out in the order the tables are built in, so when only the sprites had
+// to be built, the textures already read from it are saved where they were.
+//
+
+#define ALIGN4(x) (((x)+3) & ~3)
+
+void D_SaveSnapshot(void)
+{
+  snapshot_t *s;
+  byte *blob;
+  size_t size;
+  int i;
+
+  if (!rebuilt)
+    {
+      lprintf(LO_INFO, "D_SaveSnapshot: tables read, W_Init to P_Init %lums\n",
+              (I_GetTimeUS() - starttime) / 1000);
+      return;
+    }
+
+  size = sizeof *s + numlumps*sizeof(snaplump_t) + numtextures*sizeof(int);
+  for (i=0; i<numtextures; i++)
+    size += ALIGN4(sizeof(texture_t) + sizeof(texpatch_t)*(textures[i]->patchcount-1));
+  size += numsprites*(4 + sizeof(snapsprite_t));
+  for (i=0; i<numsprites; i++)
+    size += sprites[i].numframes*sizeof(spriteframe_t);
+
+  blob = Z_Calloc(1, size, PU_STATIC, 0);
+  s = (snapshot_t *)blob;
+  size = sizeof *s;
+
+  s->numlumps = numlumps;
+  s->lumps = size;
+  for (i=0; i<numlumps; i++, size += sizeof(snaplump_t))
+    D_PackLump((snaplump_t *)(blob + size), &lumpinfo[i]);
+
+  s->numtextures = numtextures;
+  s->textures = size;
+  size += numtextures*sizeof(int);
+  for (i=0; i<numtextures; i++)
+    {
+      int len = sizeof(texture_t) + sizeof(texpatch_t)*(textures[i]->patchcount-1);
+      ((int *)(blob + s->textures))[i] = size;
+      memcpy(blob + size, textures[i], len);
+      size += ALIGN4(len);
+    }
+
+  s->numsprites = numsprites;
+  s->spritenames = size;
+  for (i=0; i<numsprites; i++, size += 4)
+    memcpy(blob + size, sprnames[i], 4);
+  s->sprites = size;
+  size += numsprites*sizeof(snapsprite_t);
+  for (i=0; i<numsprites; i++)
+    {
+      snapsprite_t *sp = (snapsprite_t *)(blob + s->sprites) + i;
+      sp->numframes = sprites[i].numframes;
+      sp->frames = size;
+      memcpy(blob + size, sprites[i].spriteframes, sp->numframes*sizeof(spriteframe_t));
+      size += sp->numframes*sizeof(spriteframe_t);
+    }
+
+  if (I_CacheData(cache_snapshot, key, sizeof key, blob, size))
+    lprintf(LO_INFO, "D_SaveSnapshot: tables built, W_Init to P_Init %lums, %lu bytes saved\n",
+            (I_GetTimeUS() - starttime) / 1000, (unsigned long)size);
+  else
+    lprintf(LO_WARN, "D_SaveSnapshot: tables built, W_Init to P_Init %lums, %lu bytes not saved\n",
+            (I_GetTimeUS() - starttime) / 1000, (unsigned long)size);
+  Z_Free(blob);
+}
@@ -61,16 +61,21 @@ static screeninfo_t wipe_scr;
 
 static int y_lookup[MAX_SCREENWIDTH];
 
+// Byte distance between neighbouring pixels of a row and of a column; the
+// three wipe screens share screens[0]'s layout
+#define WIPE_XSTEP (V_XSTEP(wipe_scr.byte_pitch/depth)*depth)
+#define WIPE_YSTEP (V_YSTEP(wipe_scr.byte_pitch/depth)*depth)
+
 
 static int wipe_initMelt(int ticks)
 {
   int i;
 
   // copy start screen to main screen
-  for(i=0;i<SCREENHEIGHT;i++)
+  for(i=0;i<V_LINES(&wipe_scr);i++)
     memcpy(wipe_scr.data+i*wipe_scr.byte_pitch,
            wipe_scr_start.data+i*wipe_scr.byte_pitch,
-           SCREENWIDTH*V_GetPixelDepth());
+           V_LINELEN(&wipe_scr)*V_GetPixelDepth());
 
   // setup initial column positions (y<0 => not ready to scroll yet)
   y_lookup[0] = -(M_Random()%16);
@@ -87,6 +92,35 @@ static int wipe_initMelt(int ticks)
   return 0;
 }
 
+// When screens[0] is page flipped it does not hold the previous step of the
+// melt, so lay the whole thing down again from y_lookup before advancing it
+static void wipe_redrawMelt(void)
+{
+  int i, j, k, y;
+  const int depth = V_GetPixelDepth();
+
+  for (i=0;i<SCREENWIDTH;i++) {
+    byte *s, *d;
+
+    y = y_lookup[i] < 0 ? 0 : y_lookup[i];
+    s = wipe_scr_end.data + (i*WIPE_XSTEP);
+    d = wipe_scr.data     + (i*WIPE_XSTEP);
+    for (j=y;j;j--) {
+      for (k=0; k<depth; k++)
+        d[k] = s[k];
+      d += WIPE_YSTEP;
+      s += WIPE_YSTEP;
+    }
+    s = wipe_scr_start.data + (i*WIPE_XSTEP);
+    for (j=SCREENHEIGHT-y;j;j--) {
+      for (k=0; k<depth; k++)
+        d[k] = s[k];
+      d += WIPE_YSTEP;
+      s += WIPE_YSTEP;
+    }
+  }
+}
+
 static int wipe_doMelt(int ticks)
 {
   boolean done = true;
@@ -113,22 +147,22 @@ static int wipe_doMelt(int ticks)
         if (y_lookup[i]+dy >= SCREENHEIGHT)
           dy = SCREENHEIGHT - y_lookup[i];
 
-        s = wipe_scr_end.data    + (y_lookup[i]*wipe_scr_end.byte_pitch+(i*depth));
-        d = wipe_scr.data        + (y_lookup[i]*wipe_scr.byte_pitch+(i*depth));
+        s = wipe_scr_end.data    + (y_lookup[i]*WIPE_YSTEP+(i*WIPE_XSTEP));
+        d = wipe_scr.data        + (y_lookup[i]*WIPE_YSTEP+(i*WIPE_XSTEP));
         for (j=dy;j;j--) {
           for (k=0; k<depth; k++)
             d[k] = s[k];
-          d += wipe_scr.byte_pitch;
-          s += wipe_scr_end.byte_pitch;
+          d += WIPE_YSTEP;
+          s += WIPE_YSTEP;
         }
         y_lookup[i] += dy;
-        s = wipe_scr_start.data  + (i*depth);
-        d = wipe_scr.data        + (y_lookup[i]*wipe_scr.byte_pitch+(i*depth));
+        s = wipe_scr_start.data  + (i*WIPE_XSTEP);
+        d = wipe_scr.data        + (y_lookup[i]*WIPE_YSTEP+(i*WIPE_XSTEP));
         for (j=SCREENHEIGHT-y_lookup[i];j;j--) {
           for (k=0; k<depth; k++)
             d[k] = s[k];
-          d += wipe_scr.byte_pitch;
-          s += wipe_scr_end.byte_pitch;
+          d += WIPE_YSTEP;
+          s += WIPE_YSTEP;
         }
         done = false;
       }
@@ -155,6 +189,8 @@ static int wipe_exitMelt(int ticks)
 
 int wipe_StartScreen(void)
 {
+  byte *page = screens[0].data;
+
   wipe_scr_start.width = SCREENWIDTH;
   wipe_scr_start.height = SCREENHEIGHT;
   wipe_scr_start.byte_pitch = screens[0].byte_pitch;
@@ -163,7 +199,11 @@ int wipe_StartScreen(void)
   wipe_scr_start.not_on_heap = false;
   V_AllocScreen(&wipe_scr_start);
   screens[SRC_SCR] = wipe_scr_start;
+  // With page flipping screens[0] is a fresh page, what's on screen is the last finished one
+  if (use_doublebuffer)
+    screens[0].data = I_GetLastFrame();
   V_CopyRect(0, 0, 0,       SCREENWIDTH, SCREENHEIGHT, 0, 0, SRC_SCR, VPT_NONE ); // Copy start screen to buffer
+  screens[0].data = page;
   return 0;
 }
 
@@ -192,6 +232,11 @@ int wipe_ScreenWipe(int ticks)
       wipe_scr = screens[0];
       wipe_initMelt(ticks);
     }
+  else if (use_doublebuffer)
+    {
+      wipe_scr = screens[0];
+      wipe_redrawMelt();
+    }
   // do a piece of wipe-in
   if (wipe_doMelt(ticks))     // final stuff
     {
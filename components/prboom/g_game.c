@@ -484,7 +484,6 @@ void G_RestartLevel(void)
   special_event = BT_SPECIAL | (BTS_RESTARTLEVEL & BT_SPECIALMASK);
 }
 
-#include "z_bmalloc.h"
 //
 // G_DoLoadLevel
 //
@@ -553,12 +552,7 @@ static void G_DoLoadLevel (void)
   // by Z_FreeTags() when the previous level ended or player
   // died.
 
-  {
-    DECLARE_BLOCK_MEMORY_ALLOC_ZONE(secnodezone);
-    NULL_BLOCK_MEMORY_ALLOC_ZONE(secnodezone);
-      //extern msecnode_t *headsecnode; // phares 3/25/98
-      //headsecnode = NULL;
-  }
+  headsecnode = NULL;
 
   P_SetupLevel (gameepisode, gamemap, 0, gameskill);
   if (!demoplayback) // Don't switch views if playing a demo
@@ -706,6 +700,8 @@ void G_Ticker (void)
   int i;
   static gamestate_t prevgamestate;
 
+  Z_TicStats();
+
   // CPhipps - player colour changing
   if (!demoplayback && mapcolor_plyr[consoleplayer] != mapcolor_me) {
     // Changed my multiplayer colour - Inform the whole game
@@ -1499,9 +1495,10 @@ static const struct {
 } version_headers[] = {
   /* cph - we don't need a new version_header for prboom_3_comp/v2.1.1, since
    *  the file format is unchanged. */
-  { prboom_3_compatibility, "PrBoom %d", 210},
-  { prboom_5_compatibility, "PrBoom %d", 211},
-  { prboom_6_compatibility, "PrBoom %d", 212}
+  /* The thinkers are saved as they are laid out in memory, and thinker_t
+   *  (dormant thinkers) and mobj_t (sector list boxes) have grown since
+   *  PrBoom 210-212, so those saves can't be read any more. */
+  { prboom_6_compatibility, "PrBoom %d", 213}
 };
 
 static const size_t num_version_headers = sizeof(version_headers) / sizeof(version_headers[0]);
@@ -113,6 +113,45 @@
    INSTRUMENTED is also defined. */
 /* #undef HEAPDUMP */
 
+/* Define to keep 16 bit pixels byte-swapped (big-endian RGB565), the way SPI
+   LCDs take them */
+#define SWAP_RGB565 1
+
+/* Define to store screens column by column instead of row by row, so the
+   wall and sprite column drawers write consecutive bytes. Needs
+   LCD_COLUMN_MAJOR in spi_lcd.h */
+//#define COLUMN_MAJOR_SCREENS 1
+
+/* Define to draw the left and right halves of the 3D view on separate
+   cores (needs pthreads) */
+//#define SPLIT_RENDER 1
+
+/* Define to pipeline the 3D view over both cores: the BSP walk and the
+   walls of a frame are done on the game's core while the other core draws
+   the flats and sprites of the frame before it (needs pthreads). Frames
+   reach the screen a frame later. */
+//#define PIPELINE_RENDER 1
+
+#if defined SPLIT_RENDER && defined PIPELINE_RENDER
+#error "SPLIT_RENDER and PIPELINE_RENDER both want the second core"
+#endif
+
+/* Internal RAM budget. Internal RAM is a lot faster than PSRAM or flash,
+   and these all want some. Each takes what it is allowed as far as it is
+   there, first come first served, and falls back to PSRAM or the zone:
+     FB_INTERNAL           framebuffers in internal RAM, 76.8 KB each
+                           (153.6 KB with LCD_RGB565), spi_lcd.c, at boot
+     ZONE_INTERNAL_BUDGET  Z_MallocInternal blocks, z_zone.c
+     THINKER_INTERNAL      thinker slabs, p_tick.c
+     FASTRAM_BUDGET        copies of the most used lumps, w_mmap.c
+   The defaults come to about 270 KB, which leaves the display's DMA
+   buffers and the task stacks room on an ESP32-S3. A framebuffer more
+   takes the place of the last two. */
+#define FB_INTERNAL          1
+#define ZONE_INTERNAL_BUDGET (64*1024)
+#define THINKER_INTERNAL     (32*1024)
+#define FASTRAM_BUDGET       (96*1024)
+
 /* Define for high resolution support */
 #define HIGHRES 0
 
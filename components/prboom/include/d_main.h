@@ -68,6 +68,7 @@ void D_DoAdvanceDemo (void);
 //
 
 void D_Display(void);
+extern unsigned long displaycost; // smoothed D_Display time in us, for pacing
 void D_PageTicker(void);
 void D_StartTitle(void);
 void D_DoomMain(void);
@@ -0,0 +1,48 @@
+/* Emacs style mode select   -*- C++ -*-
+ *-----------------------------------------------------------------------------
+ *
+ *
+ *  PrBoom: a Doom port merged with LxDoom and LSDLDoom
+ *  based on BOOM, a modified and improved DOOM engine
+ *  Copyright (C) 1999 by
+ *  id Software, Chi Hoang, Lee Killough, Jim Flynn, Rand Phares, Ty Halderman
+ *  Copyright (C) 1999-2000 by
+ *  Jess Haas, Nicolas Kalkhof, Colin Phipps, Florian Schulze
+ *  Copyright 2005, 2006 by
+ *  Florian Schulze, Colin Phipps, Neil Stevens, Andrey Budko
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ *  02111-1307, USA.
+ *
+ * DESCRIPTION:
+ *      Warm boot snapshot of the tables built from the wads
+ *
+ *-----------------------------------------------------------------------------*/
+
+#ifndef __D_SNAPSHOT__
+#define __D_SNAPSHOT__
+
+#include "doomtype.h"
+
+/* Each of these takes its tables from the snapshot, if there is one for
+ * the wads loaded, and returns false if the caller has to build them */
+boolean D_SnapshotLumps(void);                          /* W_Init */
+boolean D_SnapshotTextures(void);                       /* R_InitTextures */
+boolean D_SnapshotSprites(const char * const *namelist); /* R_InitSpriteDefs */
+
+/* Saves the tables once they are all there, if any had to be built */
+void D_SaveSnapshot(void);
+
+#endif
@@ -89,6 +89,11 @@ typedef struct thinker_s
    * this one using pointers. Used for garbage collection.
    */
   unsigned references;
+
+  /* Ring of awake thinkers, or of those asleep until the same slot of the
+   * wake wheel, and the tic and counter to wake them with (p_tick.c) */
+  struct thinker_s *anext, *aprev;
+  int wake, *countdown;
 } thinker_t;
 
 #endif
@@ -40,7 +40,7 @@
 
 #include "m_fixed.h"
 
-extern int ms_to_next_tick;
+extern int ms_to_next_tick, us_to_next_tick; /* set by I_GetTime_RealTime */
 int I_StartDisplay(void);
 void I_EndDisplay(void);
 int I_GetTime_RealTime(void);     /* killough */
@@ -51,6 +51,8 @@ void I_GetTime_SaveMS(void);
 
 unsigned long I_GetRandomTimeSeed(void); /* cphipps */
 
+unsigned long I_GetTimeUS(void); /* microseconds, for profiling */
+
 void I_uSleep(unsigned long usecs);
 
 /* cphipps - I_GetVersionString
@@ -75,6 +77,23 @@ int I_Filelength(int handle);
 
 void I_SetAffinityMask(void);
 
+#if defined SPLIT_RENDER || defined PIPELINE_RENDER
+/* Worker thread on the other core: I_StartRenderThread creates it, then
+ * each I_SignalRenderThread makes it call func once, and
+ * I_WaitRenderThread blocks until that call has returned */
+void I_StartRenderThread(void (*func)(void));
+void I_SignalRenderThread(void);
+void I_WaitRenderThread(void);
+
+/* Serialises the render threads' use of the patch cache, and with
+ * PIPELINE_RENDER the zone as a whole. May be taken recursively. */
+void I_LockRenderCache(void);
+void I_UnlockRenderCache(void);
+#else
+#define I_LockRenderCache()
+#define I_UnlockRenderCache()
+#endif
+
 
 int doom_main(int argc, char const * const * argv);
 
@@ -91,6 +110,20 @@ void *I_Realloc(void *ptr, size_t size);
 void *I_Mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset);
 int I_Munmap(void *addr, size_t length);
 
+/* Data the engine derives from the wads and keeps across runs, each kind
+ * in a place of its own. I_GetCachedData returns the data saved under
+ * key, read in place, and sets *size, or returns NULL; I_CacheData saves
+ * data under key, then returns it the same way, or NULL. Data read
+ * before stays where it was, and reads what was saved over it. */
+typedef enum {
+  cache_tranmap,      // R_InitTranMap
+  cache_snapshot,     // d_snapshot.c
+  NUMCACHES
+} datacache_t;
+
+const void *I_GetCachedData(datacache_t cache, const void *key, size_t keysize, size_t *size);
+const void *I_CacheData(datacache_t cache, const void *key, size_t keysize, const void *data, size_t size);
+
 int isValidPtr(void *ptr);
 
 #endif
@@ -54,6 +54,25 @@ void I_SetPalette(int pal); /* CPhipps - pass down palette number */
 void I_UpdateNoBlit (void);
 void I_FinishUpdate (void);
 
+/* Rows y1..y2-1 of screens[0] hold a finished strip of the view, see
+ * render_strips. They may be sent before the frame is complete; after the
+ * last strip, this waits until the rows can be drawn over again. */
+void I_FinishViewStrip (int y1, int y2, boolean last);
+
+/* With use_doublebuffer, I_FinishUpdate flips screens[0] to another page.
+ * This returns the page that was finished last, i.e. what is on screen. */
+byte *I_GetLastFrame (void);
+
+#ifdef PIPELINE_RENDER
+/* A framebuffer other than screens[0] that nothing is using. */
+byte *I_GetFreeFrame (void);
+/* Keeps I_FinishUpdate from handing out frame as the next screens[0],
+ * as it is still being drawn into; NULL lets it go. The renderer holds
+ * a frame for one update at a time: if I_HoldFrame wasn't called since
+ * the last I_FinishUpdate, the next one calls R_DropPipelinedFrame. */
+void I_HoldFrame (byte *frame);
+#endif
+
 int I_ScreenShot (const char *fname);
 
 /* I_StartTic
@@ -39,6 +39,9 @@
 #include "p_mobj.h"
 
 void P_NoiseAlert (mobj_t *target, mobj_t *emmiter);
+void P_InitSoundGraph(void);    /* P_SetupLevel, once sectors have their lines */
+extern unsigned noisealerts;
+extern unsigned long noisealertus;
 void P_SpawnBrainTargets(void); /* killough 3/26/98: spawn icon landings */
 
 extern struct brain_s {         /* killough 3/26/98: global state of boss brain */
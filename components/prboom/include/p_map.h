@@ -52,6 +52,8 @@ boolean P_TryMove(mobj_t *thing, fixed_t x, fixed_t y, boolean dropoff);
 boolean P_TeleportMove(mobj_t *thing, fixed_t x, fixed_t y,boolean boss);
 void    P_SlideMove(mobj_t *mo);
 boolean P_CheckSight(mobj_t *t1, mobj_t *t2);
+extern unsigned sightgen;     // bump when any sector height changes
+extern unsigned sightchecks, sightcached, sightnodes;
 void    P_UseLines(player_t *player);
 
 // killough 8/2/98: add 'mask' argument to prevent friends autoaiming at others
@@ -59,14 +61,19 @@ fixed_t P_AimLineAttack(mobj_t *t1,angle_t angle,fixed_t distance, uint_64_t mas
 
 void    P_LineAttack(mobj_t *t1, angle_t angle, fixed_t distance,
                      fixed_t slope, int damage );
+extern unsigned hitscans;
+extern unsigned long hitscanus;
 void    P_RadiusAttack(mobj_t *spot, mobj_t *source, int damage);
 boolean P_CheckPosition(mobj_t *thing, fixed_t x, fixed_t y);
+extern unsigned checkpositions;
 
 //jff 3/19/98 P_CheckSector(): new routine to replace P_ChangeSector()
 boolean P_ChangeSector(sector_t* sector,boolean crunch);
 boolean P_CheckSector(sector_t *sector, boolean crunch);
 void    P_DelSeclist(msecnode_t*);                          // phares 3/16/98
 void    P_CreateSecNodeList(mobj_t*,fixed_t,fixed_t);       // phares 3/14/98
+extern msecnode_t *headsecnode;                             // phares 3/25/98
+extern unsigned secnodelists, secnodeskept, secnodesmade;
 boolean Check_Sides(mobj_t *, int, int);                    // phares
 
 int     P_GetMoveFactor(const mobj_t *mo, int *friction);   // killough 8/28/98
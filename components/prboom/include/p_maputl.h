@@ -46,6 +46,7 @@
 #define PT_ADDLINES     1
 #define PT_ADDTHINGS    2
 #define PT_EARLYOUT     4
+#define PT_SHOOTABLE    8   /* only things that can be shot */
 
 typedef struct {
   fixed_t     x;
@@ -76,7 +77,9 @@ void    P_LineOpening (const line_t *linedef);
 void    P_UnsetThingPosition(mobj_t *thing);
 void    P_SetThingPosition(mobj_t *thing);
 boolean P_BlockLinesIterator (int x, int y, boolean func(line_t *));
+boolean P_BlockLinesInBox (int x, int y, const fixed_t *bbox, boolean func(line_t *));
 boolean P_BlockThingsIterator(int x, int y, boolean func(mobj_t *));
+extern unsigned interceptcount;   /* intercepts collected, for the stats */
 boolean P_PathTraverse(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2,
                        int flags, boolean trav(intercept_t *));
 
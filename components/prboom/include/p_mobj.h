@@ -334,6 +334,10 @@ typedef struct mobj_s
     // Thing being chased/attacked for tracers.
     struct mobj_s*      tracer;
 
+    // Box, in map units, its own box can move in without touching another
+    // sector while it's in just one (P_CreateSecNodeList)
+    short               secclear[4];
+
     // new field: last known enemy -- killough 2/15/98
     struct mobj_s*      lastenemy;
 
@@ -46,8 +46,10 @@ void P_Init(void);               /* Called by startup code. */
 extern const byte *rejectmatrix;   /* for fast sight rejection -  cph - const* */
 
 /* killough 3/1/98: change blockmap from "short" to "long" offsets: */
-extern long     *blockmaplump;   /* offsets in blockmap are from here */
-extern long     *blockmap;
+#define BLOCKMAP_END 0xffff
+extern unsigned short *blockmaplump; /* offsets in blockmap are from here */
+extern int      *blockmap;
+extern fixed_t  (*linebbox)[4];  /* copy of lines[i].bbox */
 extern int      bmapwidth;
 extern int      bmapheight;      /* in mapblocks */
 extern fixed_t  bmaporgx;
@@ -45,12 +45,22 @@
 void P_Ticker(void);
 
 void P_InitThinkers(void);
+void *P_AllocThinker(size_t size);
+void P_FreeThinker(thinker_t *thinker);
+void P_FreeThinkerSlabs(void);
 void P_AddThinker(thinker_t *thinker);
 void P_RemoveThinker(thinker_t *thinker);
 void P_RemoveThinkerDelayed(thinker_t *thinker);    // killough 4/25/98
 
 void P_UpdateThinker(thinker_t *thinker);   // killough 8/29/98
 
+/* Thinkers that only count *count down to their next action can sleep
+ * until then, outside demos and netgames, when dormant_thinkers is set */
+extern int dormant_thinkers;
+void P_SleepThinker(thinker_t *thinker, int *count);
+void P_WakeThinker(thinker_t *thinker);
+void P_WakeThinkers(void);
+
 void P_SetTarget(mobj_t **mo, mobj_t *target);   // killough 11/98
 
 /* killough 8/29/98: threads of thinkers, for more efficient searches
@@ -38,21 +38,29 @@
 #pragma interface
 #endif
 
-extern seg_t    *curline;
-extern side_t   *sidedef;
-extern line_t   *linedef;
-extern sector_t *frontsector;
-extern sector_t *backsector;
+extern R_LOCAL seg_t    *curline;
+extern R_LOCAL side_t   *sidedef;
+extern R_LOCAL line_t   *linedef;
+extern R_LOCAL sector_t *frontsector;
+extern R_LOCAL sector_t *backsector;
 
 /* old code -- killough:
  * extern drawseg_t drawsegs[MAXDRAWSEGS];
  * new code -- killough: */
-extern drawseg_t *drawsegs;
-extern unsigned maxdrawsegs;
+extern R_LOCAL drawseg_t *drawsegs;
+extern R_LOCAL unsigned maxdrawsegs;
 
-extern byte solidcol[MAX_SCREENWIDTH];
+/* A bit per column, set once nothing behind it can show, a copy for each
+ * render thread; and a bit per word of them, set once the word is full */
+#define SOLIDCOL_WORDS ((MAX_SCREENWIDTH+31)/32)
+#define SOLIDCOL_FULL  ((1u << SOLIDCOL_WORDS) - 1)
+extern unsigned solidcol[RENDER_THREADS][SOLIDCOL_WORDS];
+extern R_LOCAL unsigned solidcolsum;
 
-extern drawseg_t *ds_p;
+/* Marks columns first..last-1 solid */
+void R_SetSolidCols(int first, int last);
+
+extern R_LOCAL drawseg_t *ds_p;
 
 void R_ClearClipSegs(void);
 void R_ClearDrawSegs(void);
@@ -52,6 +52,23 @@
 #pragma interface
 #endif
 
+// With SPLIT_RENDER the view is drawn by two render threads, each with
+// its own copy of the per-frame renderer state. Scalars are made thread
+// local with R_LOCAL; arrays get a [RENDER_THREADS] dimension and are
+// indexed by renderthread (r_main.h). PIPELINE_RENDER uses the same
+// split, with one set for the game's own drawing and one for each of
+// the two frames in flight.
+#ifdef SPLIT_RENDER
+#define RENDER_THREADS 2
+#define R_LOCAL __thread
+#elif defined PIPELINE_RENDER
+#define RENDER_THREADS 3
+#define R_LOCAL __thread
+#else
+#define RENDER_THREADS 1
+#define R_LOCAL
+#endif
+
 // Silhouette, needed for clipping Segs (mainly)
 // and sprites representing things.
 #define SIL_NONE    0
@@ -153,6 +170,8 @@ typedef struct
   short special;
   short oldspecial;      //jff 2/16/98 remembers if sector WAS secret (automap)
   short tag;
+
+  int spritevalidcount[RENDER_THREADS]; // if == validcount, sprites already added
 } sector_t;
 
 //
@@ -321,6 +340,12 @@ typedef struct drawseg_s
 
   // Added for filtering (fractional texture u coord) support - POPE
   fixed_t rw_offset, rw_distance, rw_centerangle; 
+
+  // Masked middle texture, light level, texture mid and translucency
+  // lump as they were when the wall was stored, so drawing it later reads
+  // nothing the game may have changed since (PIPELINE_RENDER)
+  int maskedtexnum, maskedlight, maskedtranlump;
+  fixed_t maskedtexturemid;
   
   // Pointers to lists for sprite clipping,
   // all three adjusted so [x1] is first value.
@@ -360,6 +385,11 @@ typedef struct vissprite_s
 
   // killough 3/27/98: height sector for underwater/fake ceiling support
   int heightsec;
+  // its heights, and the viewer's height sector and its heights, as they
+  // were when projected, for R_DrawSprite (PIPELINE_RENDER)
+  int phs;
+  fixed_t hsfloorheight, hsceilingheight;
+  fixed_t phsfloorheight, phsceilingheight;
 
   boolean isplayersprite;
 } vissprite_t;
@@ -418,6 +448,13 @@ typedef struct visplane
   int picnum, lightlevel, minx, maxx;
   fixed_t height;
   fixed_t xoffs, yoffs;         // killough 2/28/98: Support scrolling flats
+  // What to draw, worked out by R_FindPlane so drawing the plane later
+  // reads nothing the game may have changed since (PIPELINE_RENDER):
+  // the flat's lump, or the sky texture and its angle, mid and flip
+  int source;
+  angle_t skyangle;
+  fixed_t skymid;
+  unsigned skyflip;
   unsigned int pad1;          // leave pads for [minx-1]/[maxx+1]
   unsigned int top[MAX_SCREENWIDTH];
   unsigned int pad2, pad3;    // killough 2/8/98, 4/25/98
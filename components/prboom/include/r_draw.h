@@ -130,6 +130,16 @@ typedef struct {
 
 extern draw_vars_t drawvars;
 
+// The column and span drawers write to drawtarget's *_topleft. With
+// PIPELINE_RENDER two render threads draw into different framebuffers at
+// once; R_SetViewTarget points a thread's drawtarget at another one.
+#ifdef PIPELINE_RENDER
+extern R_LOCAL draw_vars_t *drawtarget;
+void R_SetViewTarget(byte *screen);
+#else
+#define drawtarget (&drawvars)
+#endif
+
 extern byte playernumtotrans[MAXPLAYERS]; // CPhipps - what translation table for what player
 extern byte       *translationtables;
 
@@ -145,6 +155,7 @@ R_DrawSpan_f R_GetDrawSpanFunc(enum draw_filter_type_e filter,
 void R_DrawSpan(draw_span_vars_t *dsvars);
 
 void R_InitBuffer(int width, int height);
+void R_RebaseBuffer(void);
 
 // Initialize color translation tables, for player rendering etc.
 void R_InitTranslationTables(void);
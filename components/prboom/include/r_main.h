@@ -45,8 +45,8 @@
 // POV related.
 //
 
-extern fixed_t  viewcos;
-extern fixed_t  viewsin;
+extern R_LOCAL fixed_t  viewcos;
+extern R_LOCAL fixed_t  viewsin;
 extern int      viewwidth;
 extern int      viewheight;
 extern int      viewwindowx;
@@ -61,11 +61,27 @@ extern fixed_t  projection;
 extern fixed_t  projectiony;
 extern int      validcount;
 
+// Columns viewstartx..viewstopx-1 are the ones this render thread draws
+extern R_LOCAL int viewstartx, viewstopx;
+
+#ifdef SPLIT_RENDER
+extern R_LOCAL int renderthread; // 0 on the game's core, 1 on the other
+#elif defined PIPELINE_RENDER
+extern R_LOCAL int renderthread; // 0 for the game, 1 or 2 for a frame in flight
+#else
+#define renderthread 0
+#endif
+
 //
 // Rendering stats
 //
 
-extern int rendered_visplanes, rendered_segs, rendered_vissprites;
+extern R_LOCAL int rendered_visplanes, rendered_segs, rendered_vissprites, rendered_nodes;
+// Microseconds spent on each phase of the last frame (with SPLIT_RENDER,
+// on this thread's half of the view)
+extern R_LOCAL int rendered_walltime, rendered_flattime, rendered_spritetime;
+extern int rendered_2dtime;
+extern int render_strips;
 extern boolean rendering_stats;
 
 //
@@ -84,14 +100,14 @@ extern boolean rendering_stats;
 #define LIGHTZSHIFT       20
 
 // killough 3/20/98: Allow colormaps to be dynamic (e.g. underwater)
-extern const lighttable_t *(*zlight)[MAXLIGHTZ];
-extern const lighttable_t *fullcolormap;
+extern R_LOCAL const lighttable_t *(*zlight)[MAXLIGHTZ];
+extern R_LOCAL const lighttable_t *fullcolormap;
 extern int numcolormaps;    // killough 4/4/98: dynamic number of maps
 extern const lighttable_t **colormaps;
 // killough 3/20/98, 4/4/98: end dynamic colormaps
 
-extern int          extralight;
-extern const lighttable_t *fixedcolormap;
+extern R_LOCAL int  extralight;
+extern R_LOCAL const lighttable_t *fixedcolormap;
 
 // Number of diminishing brightness levels.
 // There a 0-31, i.e. 32 LUT in the COLORMAP lump.
@@ -116,5 +132,6 @@ void R_RenderPlayerView(player_t *player);   // Called by G_Drawer.
 void R_Init(void);                           // Called by startup code.
 void R_SetViewSize(int blocks);              // Called by M_Responder.
 void R_ExecuteSetViewSize(void);             // cph - called by D_Display to complete a view resize
+void R_DropPipelinedFrame(void);             // Called by P_SetupLevel.
 
 #endif
@@ -44,8 +44,10 @@
 #define PL_SKYFLAT (0x80000000)
 
 /* Visplane related. */
-extern int *lastopening; // dropoff overflow
+extern R_LOCAL int *openings, *lastopening; // dropoff overflow
+extern R_LOCAL size_t maxopenings;
 
+/* shared by the render threads, each only uses its own columns */
 extern int floorclip[], ceilingclip[]; // dropoff overflow
 extern fixed_t yslope[], distscale[];
 
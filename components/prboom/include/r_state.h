@@ -96,21 +96,24 @@ extern side_t           *sides;
 //
 // POV data.
 //
-extern fixed_t          viewx;
-extern fixed_t          viewy;
-extern fixed_t          viewz;
-extern angle_t          viewangle;
-extern player_t         *viewplayer;
+extern R_LOCAL fixed_t  viewx;
+extern R_LOCAL fixed_t  viewy;
+extern R_LOCAL fixed_t  viewz;
+extern R_LOCAL angle_t  viewangle;
+extern R_LOCAL player_t *viewplayer;
 extern angle_t          clipangle;
 extern int              viewangletox[FINEANGLES/2];
 extern angle_t          xtoviewangle[MAX_SCREENWIDTH+1];  // killough 2/8/98
-extern fixed_t          rw_distance;
-extern angle_t          rw_normalangle;
+extern R_LOCAL fixed_t  rw_distance;
+extern R_LOCAL angle_t  rw_normalangle;
 
 // angle to line origin
-extern int              rw_angle1;
+extern R_LOCAL int      rw_angle1;
 
-extern visplane_t       *floorplane;
-extern visplane_t       *ceilingplane;
+// first and last column of the seg being added
+extern R_LOCAL int      rw_segx1, rw_segx2;
+
+extern R_LOCAL visplane_t *floorplane;
+extern R_LOCAL visplane_t *ceilingplane;
 
 #endif
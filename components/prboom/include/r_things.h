@@ -47,10 +47,14 @@ extern int screenheightarray[MAX_SCREENWIDTH]; /* change to MAX_*  */ // dropoff
 
 /* Vars for R_DrawMaskedColumn */
 
-extern int     *mfloorclip;    // dropoff overflow
-extern int     *mceilingclip;  // dropoff overflow
-extern fixed_t spryscale;
-extern fixed_t sprtopscreen;
+extern R_LOCAL int     *mfloorclip;    // dropoff overflow
+extern R_LOCAL int     *mceilingclip;  // dropoff overflow
+extern R_LOCAL fixed_t spryscale;
+extern R_LOCAL fixed_t sprtopscreen;
+
+/* Sprites collected for this frame */
+extern R_LOCAL vissprite_t *vissprites;
+extern R_LOCAL size_t num_vissprite, num_vissprite_alloc;
 extern fixed_t pspritescale;
 extern fixed_t pspriteiscale;
 /* proff 11/06/98: Added for high-res */
@@ -64,6 +68,7 @@ void R_DrawMaskedColumn(const rpatch_t *patch,
                         const rcolumn_t *nextcolumn);
 void R_SortVisSprites(void);
 void R_AddSprites(subsector_t* subsec, int lightlevel);
+void R_ProjectPlayerSprites(void);
 void R_DrawPlayerSprites(void);
 void R_InitSprites(const char * const * namelist);
 void R_ClearSprites(void);
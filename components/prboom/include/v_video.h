@@ -110,6 +110,30 @@ extern unsigned int *V_Palette32;
 #define VID_PAL16(color, weight) V_Palette16[ (color)*VID_NUMCOLORWEIGHTS + (weight) ]
 #define VID_PAL32(color, weight) V_Palette32[ (color)*VID_NUMCOLORWEIGHTS + (weight) ]
 
+// Screens are stored row by row, pitch pixels apart. With
+// COLUMN_MAJOR_SCREENS they are stored column by column instead: pitch is the
+// distance between columns and the pixels of a column are adjacent.
+#ifdef COLUMN_MAJOR_SCREENS
+#define V_XSTEP(pitch) (pitch)
+#define V_YSTEP(pitch) 1
+#define V_LINES(scrn) ((scrn)->width)
+#define V_LINELEN(scrn) ((scrn)->height)
+#else
+#define V_XSTEP(pitch) 1
+#define V_YSTEP(pitch) (pitch)
+#define V_LINES(scrn) ((scrn)->height)
+#define V_LINELEN(scrn) ((scrn)->width)
+#endif
+#define V_PIXOFS(x, y, pitch) ((x)*V_XSTEP(pitch) + (y)*V_YSTEP(pitch))
+
+// V_Palette16 holds pixels as the display takes them. Anything that does
+// arithmetic on 16 bit pixels has to go through VID_SWAP16 first and after.
+#ifdef SWAP_RGB565
+#define VID_SWAP16(c) ((unsigned short)((((c)>>8)&0xff) | ((c)<<8)))
+#else
+#define VID_SWAP16(c) (c)
+#endif
+
 // The available bit-depth modes
 typedef enum {
   VID_MODE8,
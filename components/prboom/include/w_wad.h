@@ -131,6 +131,12 @@ const void* W_CacheLumpNum (int lump);
 const void* W_LockLumpNum(int lump);
 void    W_UnlockLumpNum(int lump);
 
+// Copies of the most used lumps in internal RAM, see w_mmap.c
+const void* W_PinLumpNum(int lump);
+void    W_PromoteHotLumps(int maxbytes);
+void    W_DemoteLumps(void);
+extern unsigned w_fasthits, w_fastmisses; // W_CacheLumpNums served from the copies, and not
+
 // CPhipps - convenience macros
 //#define W_CacheLumpNum(num) (W_CacheLumpNum)((num),1)
 #define W_CacheLumpName(name) W_CacheLumpNum (W_GetNumForName(name))
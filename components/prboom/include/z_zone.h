@@ -53,6 +53,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
 
 // ZONE MEMORY
 // PU - purge tags.
@@ -71,6 +72,7 @@ enum {PU_FREE, PU_STATIC, PU_SOUND, PU_MUSIC, PU_LEVEL, PU_LEVSPEC, PU_CACHE,
 #endif
 
 void *(Z_Malloc)(size_t size, int tag, void **ptr DA(const char *, int));
+void *(Z_MallocInternal)(size_t size, int tag, void **ptr DA(const char *, int));
 void (Z_Free)(void *ptr DA(const char *, int));
 void (Z_FreeTags)(int lowtag, int hightag DA(const char *, int));
 void (Z_ChangeTag)(void *ptr, int tag DA(const char *, int));
@@ -82,6 +84,32 @@ char *(Z_Strdup)(const char *s, int tag, void **user DA(const char *, int));
 void (Z_CheckHeap)(DAC(const char *,int));   // killough 3/22/98: add file/line info
 void Z_DumpHistory(char *);
 
+/* Zone accounting, always kept. While zone_stats is on (tntmem cheat),
+ * Z_TicStats shows it once a second and sends it to the console as one
+ * line of its own: "ZST1 " and then the bytes of a zonestats_t in hex,
+ * so a reader can pick it out from among the log lines. The magic is
+ * those four characters and the fields after it are 32 bit little
+ * endian, starting with the size. */
+enum {ZT_INTERNAL, ZT_PSRAM, ZT_MAX};   /* heap_caps tier a block is in */
+
+#define ZONESTATS_MAGIC {'Z','S','T','1'}
+
+typedef struct {
+  char magic[4];
+  uint32_t size, tic;
+  uint32_t bytes[PU_MAX], blocks[PU_MAX], peakbytes[PU_MAX];
+  uint32_t tierbytes[ZT_MAX], peaktierbytes[ZT_MAX];
+  uint32_t heapfree[ZT_MAX], heapminfree[ZT_MAX], heaplargest[ZT_MAX];
+  uint32_t allocs, frees;                       /* since startup */
+  uint32_t ticallocs, ticbytes;                 /* in the last tic */
+  uint32_t peakticallocs, peakticbytes;
+  uint32_t purges, evictions, evictbytes, evictus; /* PU_CACHE evictions */
+} zonestats_t;
+
+extern zonestats_t zonestats;
+extern int zone_stats;
+void Z_TicStats(void);
+
 #ifdef INSTRUMENTED
 /* cph - save space if not debugging, don't require file 
  * and line to memory calls */
@@ -89,6 +117,7 @@ void Z_DumpHistory(char *);
 #define Z_FreeTags(a,b)    (Z_FreeTags) (a,b,    __FILE__,__LINE__)
 #define Z_ChangeTag(a,b)   (Z_ChangeTag)(a,b,    __FILE__,__LINE__)
 #define Z_Malloc(a,b,c)    (Z_Malloc)   (a,b,c,  __FILE__,__LINE__)
+#define Z_MallocInternal(a,b,c) (Z_MallocInternal)(a,b,c,__FILE__,__LINE__)
 #define Z_Strdup(a,b,c)    (Z_Strdup)   (a,b,c,  __FILE__,__LINE__)
 #define Z_Calloc(a,b,c,d)  (Z_Calloc)   (a,b,c,d,__FILE__,__LINE__)
 #define Z_Realloc(a,b,c,d) (Z_Realloc)  (a,b,c,d,__FILE__,__LINE__)
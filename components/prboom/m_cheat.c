@@ -67,6 +67,7 @@ static void cheat_behold();
 static void cheat_clev();
 static void cheat_mypos();
 static void cheat_rate();
+static void cheat_mem();
 static void cheat_comp();
 static void cheat_friction();
 static void cheat_pushers();
@@ -171,6 +172,9 @@ struct cheat_s cheat[] = {
   {"idrate",     "Frame rate",        0,
    cheat_rate     },
 
+  {"tntmem",     NULL,                always,
+   cheat_mem      },     // zone memory stats
+
   {"tntcomp",    NULL,                not_net | not_demo,
    cheat_comp     },     // phares
 
@@ -467,6 +471,12 @@ static void cheat_rate()
   rendering_stats ^= 1;
 }
 
+// zone memory stats, shown in place of the frame rate
+static void cheat_mem()
+{
+  zone_stats ^= 1;
+}
+
 // compatibility cheat
 
 static void cheat_comp()
@@ -68,8 +68,10 @@
 #include "lprintf.h"
 #include "d_main.h"
 #include "r_draw.h"
+#include "r_main.h"
 #include "r_demo.h"
 #include "r_fps.h"
+#include "p_tick.h"
 
 /* cph - disk icon not implemented */
 static inline void I_BeginRead(void) {}
@@ -201,6 +203,8 @@ default_t defaults[] =
    def_hex, ss_none}, // 0, +1 for colours, +2 for non-ascii chars, +4 for skip-last-line
   {"level_precache",{(int*)&precache},{0},0,1,
    def_bool,ss_none}, // precache level data?
+  {"dormant_thinkers",{&dormant_thinkers},{0},0,1,
+   def_bool,ss_none}, // let idle thinkers sleep outside demos and netgames
   {"demo_smoothturns", {&demo_smoothturns},  {0},0,1,
    def_bool,ss_stat},
   {"demo_smoothturnsfactor", {&demo_smoothturnsfactor},  {6},1,SMOOTH_PLAYING_MAXFACTOR,
@@ -334,6 +338,8 @@ default_t defaults[] =
    def_int,ss_none}, // gamma correction level // killough 1/18/98
   {"uncapped_framerate", {&movement_smooth},  {0},0,1,
    def_bool,ss_stat},
+  {"render_strips",{&render_strips},{0},0,8,
+   def_int,ss_none}, // draw the view in horizontal strips, streamed out one by one (slower, off by default)
   {"filter_wall",{(int*)&drawvars.filterwall},{RDRAW_FILTER_POINT},
    RDRAW_FILTER_POINT, RDRAW_FILTER_ROUNDED, def_int,ss_none},
   {"filter_floor",{(int*)&drawvars.filterfloor},{RDRAW_FILTER_POINT},
@@ -47,6 +47,7 @@
 #include "p_enemy.h"
 #include "p_tick.h"
 #include "m_bbox.h"
+#include "i_system.h"
 #include "lprintf.h"
 
 static mobj_t *current_actor;
@@ -76,45 +77,104 @@ void P_ZBumpCheck(mobj_t *);                                        // phares
 //
 
 //
-// Called by P_NoiseAlert.
-// Recursively traverse adjacent sectors,
-// sound blocking lines cut off traversal.
+// Sound propagation
 //
-// killough 5/5/98: reformatted, cleaned up
+// Sound used to be spread by recursing through the two-sided lines of each
+// sector reached, going back into a sector whenever a way into it crossing
+// fewer sound blocking lines turned up. So each sector heard ends up with
+// soundtraversed one more than the fewest it can be reached across, which
+// is either 1 or 2. P_NoiseAlert finds just that with two floods: first
+// through lines that don't block sound, then from everything reached so
+// far across one line that does, and on through lines that don't.
+//
+// P_InitSoundGraph lays out, for each sector, the sectors across its
+// two-sided lines in sec->lines order, those across non-blocking lines
+// from soundstart and blocking ones from soundsplit, in internal RAM as far
+// as the budget goes. Openings are read from the sector heights as before.
+//
+
+static unsigned short *soundedges, *soundqueue;
+static int *soundstart, *soundsplit;  // soundstart[numsectors] ends the last
+static int soundtail;
+
+// Noise alerts and the time spent in them, for the thinker stats
+unsigned noisealerts;
+unsigned long noisealertus;
 
-static void P_RecursiveSound(sector_t *sec, int soundblocks,
-           mobj_t *soundtarget)
+static int P_SoundNeighbour(const sector_t *sec, const line_t *check)
 {
-  int i;
+  if (!(check->flags & ML_TWOSIDED) || check->sidenum[1] == NO_INDEX)
+    return -1;
+  return sides[check->sidenum[sides[check->sidenum[0]].sector==sec]].sector - sectors;
+}
 
-  // wake up all monsters in this sector
-  if (sec->validcount == validcount && sec->soundtraversed <= soundblocks+1)
-    return;             // already flooded
+void P_InitSoundGraph(void)
+{
+  int i, j, pass, n = 0;
 
-  sec->validcount = validcount;
-  sec->soundtraversed = soundblocks+1;
-  P_SetTarget(&sec->soundtarget, soundtarget);
+  // Sector numbers are kept in 16 bits in the graph and the queue
+  if (numsectors > 0xffff)
+    I_Error("P_InitSoundGraph: %d sectors is too many", numsectors);
 
-  for (i=0; i<sec->linecount; i++)
+  for (i=0; i<numsectors; i++)
+    for (j=0; j<sectors[i].linecount; j++)
+      if (P_SoundNeighbour(&sectors[i], sectors[i].lines[j]) >= 0)
+        n++;
+
+  soundedges = Z_MallocInternal(n*sizeof *soundedges, PU_LEVEL, 0);
+  soundqueue = Z_MallocInternal(numsectors*sizeof *soundqueue, PU_LEVEL, 0);
+  soundstart = Z_MallocInternal((numsectors+1)*sizeof *soundstart, PU_LEVEL, 0);
+  soundsplit = Z_MallocInternal(numsectors*sizeof *soundsplit, PU_LEVEL, 0);
+
+  for (n=i=0; i<numsectors; i++)
     {
-      sector_t *other;
-      line_t *check = sec->lines[i];
+      soundstart[i] = n;
+      for (pass=0; pass<2; pass++)
+        {
+          if (pass)
+            soundsplit[i] = n;
+          for (j=0; j<sectors[i].linecount; j++)
+            {
+              const line_t *check = sectors[i].lines[j];
+              int other = P_SoundNeighbour(&sectors[i], check);
+              if (other >= 0 && !(check->flags & ML_SOUNDBLOCK) == !pass)
+                soundedges[n++] = other;
+            }
+        }
+    }
+  soundstart[numsectors] = n;
+}
 
-      if (!(check->flags & ML_TWOSIDED))
-        continue;
+// The opening of a line between a and b, as P_LineOpening has it
 
-      P_LineOpening(check);
+static boolean P_SoundOpen(const sector_t *a, const sector_t *b)
+{
+  fixed_t top = a->ceilingheight < b->ceilingheight ? a->ceilingheight : b->ceilingheight;
+  fixed_t bottom = a->floorheight > b->floorheight ? a->floorheight : b->floorheight;
+  return top - bottom > 0;
+}
 
-      if (openrange <= 0)
-        continue;       // closed door
+static void P_SoundReach(int s, int soundtraversed, mobj_t *soundtarget)
+{
+  sector_t *sec = &sectors[s];
 
-      other=sides[check->sidenum[sides[check->sidenum[0]].sector==sec]].sector;
+  sec->validcount = validcount;
+  sec->soundtraversed = soundtraversed;
+  P_SetTarget(&sec->soundtarget, soundtarget);
+  soundqueue[soundtail++] = s;
+}
 
-      if (!(check->flags & ML_SOUNDBLOCK))
-        P_RecursiveSound(other, soundblocks, soundtarget);
-      else
-        if (!soundblocks)
-          P_RecursiveSound(other, 1, soundtarget);
+static void P_SoundFlood(int head, int soundtraversed, mobj_t *soundtarget)
+{
+  for (; head < soundtail; head++)
+    {
+      const sector_t *sec = &sectors[soundqueue[head]];
+      const unsigned short *e = soundedges + soundstart[soundqueue[head]];
+      const unsigned short *end = soundedges + soundsplit[soundqueue[head]];
+
+      for (; e < end; e++)
+        if (sectors[*e].validcount != validcount && P_SoundOpen(sec, &sectors[*e]))
+          P_SoundReach(*e, soundtraversed, soundtarget);
     }
 }
 
@@ -125,8 +185,28 @@ static void P_RecursiveSound(sector_t *sec, int soundblocks,
 //
 void P_NoiseAlert(mobj_t *target, mobj_t *emitter)
 {
+  unsigned long starttime = I_GetTimeUS();
+  int i, reached;
+
   validcount++;
-  P_RecursiveSound(emitter->subsector->sector, 0, target);
+  soundtail = 0;
+  P_SoundReach(emitter->subsector->sector - sectors, 1, target);
+  P_SoundFlood(0, 1, target);
+
+  for (reached = soundtail, i = 0; i < reached; i++)
+    {
+      const sector_t *sec = &sectors[soundqueue[i]];
+      const unsigned short *e = soundedges + soundsplit[soundqueue[i]];
+      const unsigned short *end = soundedges + soundstart[soundqueue[i]+1];
+
+      for (; e < end; e++)
+        if (sectors[*e].validcount != validcount && P_SoundOpen(sec, &sectors[*e]))
+          P_SoundReach(*e, 2, target);
+    }
+  P_SoundFlood(reached, 2, target);
+
+  noisealerts++;
+  noisealertus += I_GetTimeUS() - starttime;
 }
 
 //
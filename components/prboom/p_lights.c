@@ -59,7 +59,10 @@ void T_FireFlicker (fireflicker_t* flick)
   int amount;
 
   if (--flick->count)
-    return;
+    {
+      P_SleepThinker(&flick->thinker, &flick->count);
+      return;
+    }
 
   amount = (P_Random(pr_lights)&3)*16;
 
@@ -69,6 +72,7 @@ void T_FireFlicker (fireflicker_t* flick)
     flick->sector->lightlevel = flick->maxlight - amount;
 
   flick->count = 4;
+  P_SleepThinker(&flick->thinker, &flick->count);
 }
 
 //
@@ -82,7 +86,10 @@ void T_FireFlicker (fireflicker_t* flick)
 void T_LightFlash (lightflash_t* flash)
 {
   if (--flash->count)
-    return;
+    {
+      P_SleepThinker(&flash->thinker, &flash->count);
+      return;
+    }
 
   if (flash->sector->lightlevel == flash->maxlight)
   {
@@ -94,7 +101,7 @@ void T_LightFlash (lightflash_t* flash)
     flash-> sector->lightlevel = flash->maxlight;
     flash->count = (P_Random(pr_lights)&flash->maxtime)+1;
   }
-
+  P_SleepThinker(&flash->thinker, &flash->count);
 }
 
 //
@@ -108,7 +115,10 @@ void T_LightFlash (lightflash_t* flash)
 void T_StrobeFlash (strobe_t*   flash)
 {
   if (--flash->count)
-    return;
+    {
+      P_SleepThinker(&flash->thinker, &flash->count);
+      return;
+    }
 
   if (flash->sector->lightlevel == flash->minlight)
   {
@@ -120,6 +130,7 @@ void T_StrobeFlash (strobe_t*   flash)
     flash-> sector->lightlevel = flash->minlight;
     flash->count =flash->darktime;
   }
+  P_SleepThinker(&flash->thinker, &flash->count);
 }
 
 //
@@ -182,7 +193,7 @@ void P_SpawnFireFlicker (sector_t*  sector)
   // Nothing special about it during gameplay.
   sector->special &= ~31; //jff 3/14/98 clear non-generalized sector type
 
-  flick = Z_Malloc ( sizeof(*flick), PU_LEVSPEC, 0);
+  flick = P_AllocThinker (sizeof(*flick));
 
   memset(flick, 0, sizeof(*flick));
   P_AddThinker (&flick->thinker);
@@ -209,7 +220,7 @@ void P_SpawnLightFlash (sector_t* sector)
   // nothing special about it during gameplay
   sector->special &= ~31; //jff 3/14/98 clear non-generalized sector type
 
-  flash = Z_Malloc ( sizeof(*flash), PU_LEVSPEC, 0);
+  flash = P_AllocThinker (sizeof(*flash));
 
   memset(flash, 0, sizeof(*flash));
   P_AddThinker (&flash->thinker);
@@ -241,7 +252,7 @@ void P_SpawnStrobeFlash
 {
   strobe_t* flash;
 
-  flash = Z_Malloc ( sizeof(*flash), PU_LEVSPEC, 0);
+  flash = P_AllocThinker (sizeof(*flash));
 
   memset(flash, 0, sizeof(*flash));
   P_AddThinker (&flash->thinker);
@@ -277,7 +288,7 @@ void P_SpawnGlowingLight(sector_t*  sector)
 {
   glow_t* g;
 
-  g = Z_Malloc( sizeof(*g), PU_LEVSPEC, 0);
+  g = P_AllocThinker(sizeof(*g));
 
   memset(g, 0, sizeof(*g));
   P_AddThinker(&g->thinker);
@@ -38,12 +38,14 @@
 #include "p_maputl.h"
 #include "p_map.h"
 #include "p_setup.h"
+#include "p_tick.h"
 #include "p_spec.h"
 #include "s_sound.h"
 #include "sounds.h"
 #include "p_inter.h"
 #include "m_random.h"
 #include "m_bbox.h"
+#include "i_system.h"
 #include "lprintf.h"
 
 static mobj_t    *tmthing;
@@ -698,6 +700,8 @@ boolean Check_Sides(mobj_t* actor, int x, int y)
 //  numspeciallines
 //
 
+unsigned checkpositions;    // calls, for the thinker stats
+
 boolean P_CheckPosition (mobj_t* thing,fixed_t x,fixed_t y)
   {
   int     xl;
@@ -708,6 +712,7 @@ boolean P_CheckPosition (mobj_t* thing,fixed_t x,fixed_t y)
   int     by;
   subsector_t*  newsubsec;
 
+  checkpositions++;
   tmthing = thing;
 
   tmx = x;
@@ -765,7 +770,7 @@ boolean P_CheckPosition (mobj_t* thing,fixed_t x,fixed_t y)
 
   for (bx=xl ; bx<=xh ; bx++)
     for (by=yl ; by<=yh ; by++)
-      if (!P_BlockLinesIterator (bx,by,PIT_CheckLine))
+      if (!P_BlockLinesInBox (bx,by,tmbbox,PIT_CheckLine))
         return false; // doesn't fit
 
   return true;
@@ -1620,7 +1625,7 @@ fixed_t P_AimLineAttack(mobj_t* t1,angle_t angle,fixed_t distance, uint_64_t mas
   /* killough 8/2/98: prevent friends from aiming at friends */
   aim_flags_mask = mask;
 
-  P_PathTraverse(t1->x,t1->y,x2,y2,PT_ADDLINES|PT_ADDTHINGS,PTR_AimTraverse);
+  P_PathTraverse(t1->x,t1->y,x2,y2,PT_ADDLINES|PT_ADDTHINGS|PT_SHOOTABLE,PTR_AimTraverse);
 
   if (linetarget)
     return aimslope;
@@ -1635,6 +1640,9 @@ fixed_t P_AimLineAttack(mobj_t* t1,angle_t angle,fixed_t distance, uint_64_t mas
 // that will leave linetarget set.
 //
 
+unsigned hitscans;          // calls and time in them, for the thinker stats
+unsigned long hitscanus;
+
 void P_LineAttack
 (mobj_t* t1,
  angle_t angle,
@@ -1644,6 +1652,7 @@ void P_LineAttack
   {
   fixed_t x2;
   fixed_t y2;
+  unsigned long starttime = I_GetTimeUS();
 
   angle >>= ANGLETOFINESHIFT;
   shootthing = t1;
@@ -1654,7 +1663,9 @@ void P_LineAttack
   attackrange = distance;
   aimslope = slope;
 
-  P_PathTraverse(t1->x,t1->y,x2,y2,PT_ADDLINES|PT_ADDTHINGS,PTR_ShootTraverse);
+  P_PathTraverse(t1->x,t1->y,x2,y2,PT_ADDLINES|PT_ADDTHINGS|PT_SHOOTABLE,PTR_ShootTraverse);
+  hitscans++;
+  hitscanus += I_GetTimeUS() - starttime;
   }
 
 
@@ -1872,6 +1883,8 @@ boolean PIT_ChangeSector (mobj_t* thing)
   {
   mobj_t* mo;
 
+  P_WakeThinker(&thing->thinker);   // it may have been moved
+
   if (P_ThingHeightClip (thing))
     return true; // keep checking
 
@@ -2003,23 +2016,46 @@ boolean P_CheckSector(sector_t* sector,boolean crunch)
   }
 
 
-// CPhipps -
-// Use block memory allocator here
+// Sector nodes are kept on a freelist, threaded through m_tnext and cut
+// SECNODE_CHUNK at a time from PU_LEVEL blocks in internal RAM, as far as
+// Z_MallocInternal's budget goes. Things moving about get and put nodes all
+// the time, and the block memory allocator looked through every pool for
+// the one a node came from. G_DoLoadLevel empties the list, as Z_FreeTags
+// takes the chunks with the level.
+
+#define SECNODE_CHUNK 64
 
-#include "z_bmalloc.h"
+msecnode_t *headsecnode;                                    // phares 3/25/98
 
-IMPLEMENT_BLOCK_MEMORY_ALLOC_ZONE(secnodezone, sizeof(msecnode_t), PU_LEVEL, 32, "SecNodes");
+// Sector lists built and kept as they were, and nodes got, for the stats
+unsigned secnodelists, secnodeskept, secnodesmade;
 
 inline static msecnode_t* P_GetSecnode(void)
 {
-  return (msecnode_t*)Z_BMalloc(&secnodezone);
+  msecnode_t *node;
+
+  if (!headsecnode)
+    {
+      int i;
+      node = Z_MallocInternal(SECNODE_CHUNK*sizeof *node, PU_LEVEL, 0);
+      for (i=0; i<SECNODE_CHUNK; i++, node++)
+        {
+          node->m_tnext = headsecnode;
+          headsecnode = node;
+        }
+    }
+  node = headsecnode;
+  headsecnode = node->m_tnext;
+  secnodesmade++;
+  return node;
 }
 
 // P_PutSecnode() returns a node to the freelist.
 
 inline static void P_PutSecnode(msecnode_t* node)
 {
-  Z_BFree(&secnodezone, node);
+  node->m_tnext = headsecnode;
+  headsecnode = node;
 }
 
 // phares 3/16/98
@@ -2168,6 +2204,78 @@ boolean PIT_GetSectors(line_t* ld)
   }
 
 
+//
+// P_SetSecClear
+// A thing touching just one sector keeps the same sector list for as long
+// as its box stays in a clear box around it that no line into another
+// sector crosses. It's grown SECCLEAR_MARGIN each way and then cut back
+// to the near edge of the bbox of each such line that does cross it, or
+// left empty if there's no near edge. Stored in whole units, rounded in.
+//
+
+#define SECCLEAR_MARGIN (32*FRACUNIT)
+
+static void P_SetSecClear(mobj_t *thing)
+{
+  const sector_t *sec = thing->subsector->sector;
+  fixed_t box[4];
+  int bx, by, xl, xh, yl, yh;
+
+  box[BOXTOP]    = tmbbox[BOXTOP] + SECCLEAR_MARGIN;
+  box[BOXBOTTOM] = tmbbox[BOXBOTTOM] - SECCLEAR_MARGIN;
+  box[BOXRIGHT]  = tmbbox[BOXRIGHT] + SECCLEAR_MARGIN;
+  box[BOXLEFT]   = tmbbox[BOXLEFT] - SECCLEAR_MARGIN;
+
+  xl = (box[BOXLEFT] - bmaporgx)>>MAPBLOCKSHIFT;
+  xh = (box[BOXRIGHT] - bmaporgx)>>MAPBLOCKSHIFT;
+  yl = (box[BOXBOTTOM] - bmaporgy)>>MAPBLOCKSHIFT;
+  yh = (box[BOXTOP] - bmaporgy)>>MAPBLOCKSHIFT;
+
+  // Lines in several blocks are seen more than once, which is harmless
+  // here, and leaving validcount alone keeps it as it was for demos
+  for (bx=xl ; bx<=xh ; bx++)
+    for (by=yl ; by<=yh ; by++)
+      {
+        const unsigned short *list;
+
+        if (bx<0 || by<0 || bx>=bmapwidth || by>=bmapheight)
+          continue;
+        for (list = blockmaplump + blockmap[by*bmapwidth+bx]; *list != BLOCKMAP_END; list++)
+          {
+            const fixed_t *lb = linebbox[*list];
+            const line_t *ld;
+
+            if (box[BOXRIGHT] <= lb[BOXLEFT] || box[BOXLEFT] >= lb[BOXRIGHT] ||
+                box[BOXTOP] <= lb[BOXBOTTOM] || box[BOXBOTTOM] >= lb[BOXTOP])
+              continue;
+            ld = &lines[*list];
+            if ((ld->frontsector == sec && (!ld->backsector || ld->backsector == sec)) ||
+                P_BoxOnLineSide(box, ld) != -1)
+              continue;
+
+            if (lb[BOXLEFT] >= tmbbox[BOXRIGHT])
+              box[BOXRIGHT] = lb[BOXLEFT];
+            else if (lb[BOXRIGHT] <= tmbbox[BOXLEFT])
+              box[BOXLEFT] = lb[BOXRIGHT];
+            else if (lb[BOXBOTTOM] >= tmbbox[BOXTOP])
+              box[BOXTOP] = lb[BOXBOTTOM];
+            else if (lb[BOXTOP] <= tmbbox[BOXBOTTOM])
+              box[BOXBOTTOM] = lb[BOXTOP];
+            else
+              {
+                thing->secclear[BOXLEFT] = 1;     // empty
+                thing->secclear[BOXRIGHT] = 0;
+                return;
+              }
+          }
+      }
+
+  thing->secclear[BOXTOP]    = MIN(box[BOXTOP]>>FRACBITS, SHRT_MAX);
+  thing->secclear[BOXBOTTOM] = MAX((box[BOXBOTTOM]+FRACUNIT-1)>>FRACBITS, -SHRT_MAX);
+  thing->secclear[BOXRIGHT]  = MIN(box[BOXRIGHT]>>FRACBITS, SHRT_MAX);
+  thing->secclear[BOXLEFT]   = MAX((box[BOXLEFT]+FRACUNIT-1)>>FRACBITS, -SHRT_MAX);
+}
+
 // phares 3/14/98
 //
 // P_CreateSecNodeList alters/creates the sector_list that shows what sectors
@@ -2185,18 +2293,6 @@ void P_CreateSecNodeList(mobj_t* thing,fixed_t x,fixed_t y)
   mobj_t* saved_tmthing = tmthing; /* cph - see comment at func end */
   fixed_t saved_tmx = tmx, saved_tmy = tmy; /* ditto */
 
-  // First, clear out the existing m_thing fields. As each node is
-  // added or verified as needed, m_thing will be set properly. When
-  // finished, delete all nodes where m_thing is still NULL. These
-  // represent the sectors the Thing has vacated.
-
-  node = sector_list;
-  while (node)
-    {
-    node->m_thing = NULL;
-    node = node->m_tnext;
-    }
-
   tmthing = thing;
 
   tmx = x;
@@ -2209,6 +2305,30 @@ void P_CreateSecNodeList(mobj_t* thing,fixed_t x,fixed_t y)
 
   validcount++; // used to make sure we only process a line once
 
+  secnodelists++;
+  if (sector_list && !sector_list->m_tnext &&
+      sector_list->m_sector == thing->subsector->sector &&
+      tmbbox[BOXLEFT] >= thing->secclear[BOXLEFT]<<FRACBITS &&
+      tmbbox[BOXRIGHT] <= thing->secclear[BOXRIGHT]<<FRACBITS &&
+      tmbbox[BOXBOTTOM] >= thing->secclear[BOXBOTTOM]<<FRACBITS &&
+      tmbbox[BOXTOP] <= thing->secclear[BOXTOP]<<FRACBITS)
+    {
+      secnodeskept++;   // the scan below would find just the same sector
+      goto done;
+    }
+
+  // First, clear out the existing m_thing fields. As each node is
+  // added or verified as needed, m_thing will be set properly. When
+  // finished, delete all nodes where m_thing is still NULL. These
+  // represent the sectors the Thing has vacated.
+
+  node = sector_list;
+  while (node)
+    {
+    node->m_thing = NULL;
+    node = node->m_tnext;
+    }
+
   xl = (tmbbox[BOXLEFT] - bmaporgx)>>MAPBLOCKSHIFT;
   xh = (tmbbox[BOXRIGHT] - bmaporgx)>>MAPBLOCKSHIFT;
   yl = (tmbbox[BOXBOTTOM] - bmaporgy)>>MAPBLOCKSHIFT;
@@ -2216,7 +2336,7 @@ void P_CreateSecNodeList(mobj_t* thing,fixed_t x,fixed_t y)
 
   for (bx=xl ; bx<=xh ; bx++)
     for (by=yl ; by<=yh ; by++)
-      P_BlockLinesIterator(bx,by,PIT_GetSectors);
+      P_BlockLinesInBox(bx,by,tmbbox,PIT_GetSectors);
 
   // Add the sector of the (x,y) point to sector_list.
 
@@ -2238,6 +2358,10 @@ void P_CreateSecNodeList(mobj_t* thing,fixed_t x,fixed_t y)
       node = node->m_tnext;
     }
 
+  if (!sector_list->m_tnext)
+    P_SetSecClear(thing);
+
+ done:
   /* cph -
    * This is the strife we get into for using global variables. tmthing
    *  is being used by several different functions calling
@@ -360,7 +360,7 @@ void P_SetThingPosition(mobj_t *thing)
 boolean P_BlockLinesIterator(int x, int y, boolean func(line_t*))
 {
   int        offset;
-  const long *list;   // killough 3/1/98: for removal of blockmap limit
+  const unsigned short *list;   // killough 3/1/98: for removal of blockmap limit
 
   if (x<0 || y<0 || x>=bmapwidth || y>=bmapheight)
     return true;
@@ -375,7 +375,7 @@ boolean P_BlockLinesIterator(int x, int y, boolean func(line_t*))
 
   if (!demo_compatibility) // killough 2/22/98: demo_compatibility check
     list++;     // skip 0 starting delimiter                      // phares
-  for ( ; *list != -1 ; list++)                                   // phares
+  for ( ; *list != BLOCKMAP_END ; list++)                         // phares
     {
       line_t *ld = &lines[*list];
       if (ld->validcount == validcount)
@@ -387,6 +387,41 @@ boolean P_BlockLinesIterator(int x, int y, boolean func(line_t*))
   return true;  // everything was checked
 }
 
+//
+// P_BlockLinesInBox
+// As P_BlockLinesIterator, for a func that starts by passing over lines
+// whose bbox doesn't overlap bbox: those are passed over here, from
+// linebbox, without reading their line_t. They're not marked checked,
+// which makes no difference as they'd be passed over again.
+//
+
+boolean P_BlockLinesInBox(int x, int y, const fixed_t *bbox, boolean func(line_t*))
+{
+  const unsigned short *list;
+
+  if (x<0 || y<0 || x>=bmapwidth || y>=bmapheight)
+    return true;
+  list = blockmaplump + blockmap[y*bmapwidth+x];
+
+  if (!demo_compatibility)
+    list++;
+  for ( ; *list != BLOCKMAP_END ; list++)
+    {
+      const fixed_t *lb = linebbox[*list];
+      line_t *ld;
+      if (bbox[BOXRIGHT] <= lb[BOXLEFT] || bbox[BOXLEFT] >= lb[BOXRIGHT] ||
+          bbox[BOXTOP] <= lb[BOXBOTTOM] || bbox[BOXBOTTOM] >= lb[BOXTOP])
+        continue;
+      ld = &lines[*list];
+      if (ld->validcount == validcount)
+        continue;
+      ld->validcount = validcount;
+      if (!func(ld))
+        return false;
+    }
+  return true;
+}
+
 //
 // P_BlockThingsIterator
 //
@@ -408,6 +443,8 @@ boolean P_BlockThingsIterator(int x, int y, boolean func(mobj_t*))
 
 // 1/11/98 killough: Intercept limit removed
 static intercept_t *intercepts, *intercept_p;
+static int ptflags;             // flags of the P_PathTraverse collecting
+unsigned interceptcount;
 
 // Check for limit and double size if necessary -- killough
 static void check_intercept(void)
@@ -487,6 +524,11 @@ boolean PIT_AddThingIntercepts(mobj_t *thing)
   divline_t dl;
   fixed_t   frac;
 
+  // Shots and aiming pass over anything that can't be shot, and nothing
+  // they hit first makes another thing shootable, so leave it out
+  if (ptflags & PT_SHOOTABLE && !(thing->flags & MF_SHOOTABLE))
+    return true;
+
   // check a corner to corner crossection for hit
   if ((trace.dx ^ trace.dy) > 0)
     {
@@ -535,23 +577,33 @@ boolean PIT_AddThingIntercepts(mobj_t *thing)
 // for all lines.
 //
 // killough 5/3/98: reformatted, cleaned up
+//
+// The intercepts are collected block by block along the trace, so they
+// are nearly in order already: one insertion sort puts them in order,
+// where picking the nearest left each time rescanned the whole list.
+// The sort is stable, so equal fracs still go in the order they were
+// found, as the scan for the first smallest had them.
 
 boolean P_TraverseIntercepts(traverser_t func, fixed_t maxfrac)
 {
-  intercept_t *in = NULL;
-  int count = intercept_p - intercepts;
-  while (count--)
+  intercept_t *in, *scan;
+
+  interceptcount += intercept_p - intercepts;
+  for (in = intercepts + 1; in < intercept_p; in++)
+    if (in->frac < in[-1].frac)
+      {
+        intercept_t t = *in;
+        for (scan = in; scan > intercepts && t.frac < scan[-1].frac; scan--)
+          *scan = scan[-1];
+        *scan = t;
+      }
+
+  for (in = intercepts; in < intercept_p; in++)
     {
-      fixed_t dist = INT_MAX;
-      intercept_t *scan;
-      for (scan = intercepts; scan < intercept_p; scan++)
-        if (scan->frac < dist)
-          dist = (in=scan)->frac;
-      if (dist > maxfrac)
+      if (in->frac > maxfrac)
         return true;    // checked everything in range
       if (!func(in))
         return false;           // don't bother going farther
-      in->frac = INT_MAX;
     }
   return true;                  // everything was traversed
 }
@@ -579,6 +631,7 @@ boolean P_PathTraverse(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2,
 
   validcount++;
   intercept_p = intercepts;
+  ptflags = flags;
 
   if (!((x1-bmaporgx)&(MAPBLOCKSIZE-1)))
     x1 += FRACUNIT;     // don't side exactly on a line
@@ -45,6 +45,7 @@
 #include "info.h"
 #include "g_game.h"
 #include "p_inter.h"
+#include "p_enemy.h"
 #include "lprintf.h"
 #include "r_demo.h"
 
@@ -72,6 +73,8 @@ boolean P_SetMobjState(mobj_t* mobj,statenum_t state)
 	seenstate = seenstate_tab;
   }
 
+  P_WakeThinker(&mobj->thinker);  // a state set from outside overrides its sleep
+
   if (recursion++)                            // if recursion detected,
     memset(seenstate=tempstate,0,sizeof tempstate); // clear state table
 
@@ -780,6 +783,14 @@ void P_MobjThinker (mobj_t* mobj)
     if (!mobj->tics)
       if (!P_SetMobjState (mobj, mobj->state->nextstate) )
         return;     // freed itself
+
+    // A monster standing still in A_Look only counts down till its next
+    // look, so it can sleep till then. Anything that moves it, hurts it or
+    // changes its state wakes it.
+
+    if (mobj->state->action == A_Look && !(mobj->momx | mobj->momy | mobj->momz) &&
+        mobj->z == mobj->floorz && !(mobj->flags & MF_SKULLFLY) && !mobj->player)
+      P_SleepThinker(&mobj->thinker, &mobj->tics);
     }
   else
     {
@@ -818,7 +829,7 @@ mobj_t* P_SpawnMobj(fixed_t x,fixed_t y,fixed_t z,mobjtype_t type)
   state_t*    st;
   mobjinfo_t* info;
 
-  mobj = Z_Malloc (sizeof(*mobj), PU_LEVEL, NULL);
+  mobj = P_AllocThinker (sizeof(*mobj));
   memset (mobj, 0, sizeof (*mobj));
   info = &mobjinfo[type];
   mobj->type = type;
@@ -133,10 +133,15 @@ enum
 int       bmapwidth, bmapheight;  // size in mapblocks
 
 // killough 3/1/98: remove blockmap limit internally:
-long      *blockmap;              // was short -- killough
+int       *blockmap;              // was short -- killough
 
-// offsets in blockmap are from here
-long      *blockmaplump;          // was short -- killough
+// offsets in blockmap are from here. The lists hold 16 bit line numbers,
+// ending in BLOCKMAP_END, and sit in internal RAM with blockmap and
+// linebbox while they fit: they're read by every move.
+unsigned short *blockmaplump;
+
+// each line's bbox, so the iterators can reject lines without line_t
+fixed_t   (*linebbox)[4];
 
 fixed_t   bmaporgx, bmaporgy;     // origin of block map
 
@@ -1137,22 +1142,23 @@ static void P_CreateBlockMap(void)
 
   // Create the blockmap lump
 
-  blockmaplump = Z_Malloc(sizeof(*blockmaplump) * (4+NBlocks+linetotal),
-                          PU_LEVEL, 0);
+  blockmap = Z_MallocInternal(sizeof(*blockmap) * NBlocks, PU_LEVEL, 0);
+  blockmaplump = Z_MallocInternal(sizeof(*blockmaplump) * linetotal, PU_LEVEL, 0);
+
   // blockmap header
 
-  blockmaplump[0] = bmaporgx = xorg << FRACBITS;
-  blockmaplump[1] = bmaporgy = yorg << FRACBITS;
-  blockmaplump[2] = bmapwidth  = ncols;
-  blockmaplump[3] = bmapheight = nrows;
+  bmaporgx = xorg << FRACBITS;
+  bmaporgy = yorg << FRACBITS;
+  bmapwidth  = ncols;
+  bmapheight = nrows;
 
   // offsets to lists and block lists
 
   for (i=0;i<NBlocks;i++)
   {
     linelist_t *bl = blocklists[i];
-    long offs = blockmaplump[4+i] =   // set offset to block's list
-      (i? blockmaplump[4+i-1] : 4+NBlocks) + (i? blockcount[i-1] : 0);
+    long offs = blockmap[i] =   // set offset to block's list
+      i ? blockmap[i-1] + blockcount[i-1] : 0;
 
     // add the lines in each block's list to the blockmaplump
     // delete each list node as we go
@@ -1189,43 +1195,60 @@ static void P_CreateBlockMap(void)
 static void P_LoadBlockMap (int lump)
 {
   long count;
+  int i;
+
+  // Line numbers are kept in 16 bits, and BLOCKMAP_END is one of them
+  if (numlines >= BLOCKMAP_END)
+    I_Error("P_LoadBlockMap: %d lines is too many", numlines);
 
   if (M_CheckParm("-blockmap") || W_LumpLength(lump)<8 || (count = W_LumpLength(lump)/2) >= 0x10000) //e6y
     P_CreateBlockMap();
   else
     {
-      long i;
       // cph - const*, wad lump handling updated
       const short *wadblockmaplump = W_CacheLumpNum(lump);
-      blockmaplump = Z_Malloc(sizeof(*blockmaplump) * count, PU_LEVEL, 0);
 
-      // killough 3/1/98: Expand wad blockmap into larger internal one,
-      // by treating all offsets except -1 as unsigned and zero-extending
-      // them. This potentially doubles the size of blockmaps allowed,
-      // because Doom originally considered the offsets as always signed.
+      bmaporgx = SHORT(wadblockmaplump[0])<<FRACBITS;
+      bmaporgy = SHORT(wadblockmaplump[1])<<FRACBITS;
+      bmapwidth = SHORT(wadblockmaplump[2]) & 0xffff;
+      bmapheight = SHORT(wadblockmaplump[3]) & 0xffff;
 
-      blockmaplump[0] = SHORT(wadblockmaplump[0]);
-      blockmaplump[1] = SHORT(wadblockmaplump[1]);
-      blockmaplump[2] = (long)(SHORT(wadblockmaplump[2])) & 0xffff;
-      blockmaplump[3] = (long)(SHORT(wadblockmaplump[3])) & 0xffff;
-
-      for (i=4 ; i<count ; i++)
+      // A lump too short for its own offsets is built again instead
+      if (count < 4 + bmapwidth*bmapheight)
         {
-          short t = SHORT(wadblockmaplump[i]);          // killough 3/1/98
-          blockmaplump[i] = t == -1 ? -1l : (long) t & 0xffff;
+          W_UnlockLumpNum(lump);
+          P_CreateBlockMap();
+        }
+      else
+        {
+          // The lists are left where they are in the lump, so the offsets
+          // still index them
+          blockmap = Z_MallocInternal(sizeof(*blockmap) * bmapwidth*bmapheight, PU_LEVEL, 0);
+          blockmaplump = Z_MallocInternal(sizeof(*blockmaplump) * count, PU_LEVEL, 0);
+
+          // killough 3/1/98: Expand wad blockmap into larger internal one,
+          // by treating all offsets except -1 as unsigned and zero-extending
+          // them. This potentially doubles the size of blockmaps allowed,
+          // because Doom originally considered the offsets as always signed.
+
+          for (i=0 ; i<count ; i++)
+            blockmaplump[i] = SHORT(wadblockmaplump[i]);   // -1 is BLOCKMAP_END
+          for (i=0 ; i<bmapwidth*bmapheight ; i++)
+            {
+              short t = SHORT(wadblockmaplump[4+i]);          // killough 3/1/98
+              blockmap[i] = t == -1 ? -1 : t & 0xffff;
+            }
+
+          W_UnlockLumpNum(lump); // cph - unlock the lump
         }
-
-      W_UnlockLumpNum(lump); // cph - unlock the lump
-
-      bmaporgx = blockmaplump[0]<<FRACBITS;
-      bmaporgy = blockmaplump[1]<<FRACBITS;
-      bmapwidth = blockmaplump[2];
-      bmapheight = blockmaplump[3];
     }
 
+  linebbox = Z_MallocInternal(sizeof(*linebbox) * numlines, PU_LEVEL, 0);
+  for (i=0; i<numlines; i++)
+    memcpy(linebbox[i], lines[i].bbox, sizeof(linebbox[i]));
+
   // clear out mobj chains - CPhipps - use calloc
   blocklinks = Z_Calloc (bmapwidth*bmapheight,sizeof(*blocklinks),PU_LEVEL,0);
-  blockmap = blockmaplump+4;
 }
 
 //
@@ -1508,6 +1531,7 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
   int   gl_lumpnum;
 
   R_StopAllInterpolations();
+  R_DropPipelinedFrame();
 
   totallive = totalkills = totalitems = totalsecret = wminfo.maxfrags = 0;
   wminfo.partime = 180;
@@ -1521,11 +1545,14 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
   // Make sure all sounds are stopped before Z_FreeTags.
   S_Start();
 
+  P_FreeThinkerSlabs();  // reads the zone slabs, so before they go
   Z_FreeTags(PU_LEVEL, PU_PURGELEVEL-1);
+  sightgen++;       // nothing cached from the last level applies
   if (rejectlump != -1) { // cph - unlock the reject table
     W_UnlockLumpNum(rejectlump);
     rejectlump = -1;
   }
+  W_DemoteLumps();
 
 #ifdef GL_DOOM
 // proff 11/99: clean the memory from textures etc.
@@ -1611,6 +1638,7 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
   // reject loading and underflow padding separated out into new function
   // P_GroupLines modified to return a number the underflow padding needs
   P_LoadReject(lumpnum, P_GroupLines());
+  P_InitSoundGraph();
 
   // e6y
   // Correction of desync on dv04-423.lmp/dv.wad
@@ -1666,6 +1694,9 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
   if (precache)
     R_PrecacheLevel();
 
+  // the lumps the last levels used most, into internal RAM
+  W_PromoteHotLumps(FASTRAM_BUDGET);
+
 #ifdef GL_DOOM
   if (V_GetMode() == VID_MODEGL)
   {
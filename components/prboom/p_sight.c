@@ -55,6 +55,26 @@ typedef struct {
 
 static los_t los; // cph - made static
 
+// Sight cache
+//
+// Monsters ask about the same pairs several times a tic, and idle ones ask
+// every tic. The answer only depends on where the two are and on sector
+// heights, so it's kept by their positions in a small direct mapped table,
+// all of which goes stale when sightgen is bumped by a sector moving.
+
+#define SIGHTCACHE_SIZE 128   // must be a power of 2
+
+typedef struct {
+  fixed_t x1, y1, z1, h1, x2, y2, z2, h2;
+  const subsector_t *ss1, *ss2;
+  unsigned gen;
+  boolean visible;
+} sightcache_t;
+
+static sightcache_t sightcache[SIGHTCACHE_SIZE];
+unsigned sightgen = 1;        // the cache starts out stale
+unsigned sightchecks, sightcached, sightnodes;
+
 //
 // P_DivlineSide
 // Returns side 0 (front), 1 (back), or 2 (on).
@@ -207,6 +227,7 @@ static boolean P_CrossBSPNode_LxDoom(int bspnum)
     {
       register const node_t *bsp = nodes + bspnum;
       int side,side2;
+      sightnodes++;
       side = R_PointOnSide(los.strace.x, los.strace.y, bsp);
       side2 = R_PointOnSide(los.t2x, los.t2y, bsp);
       if (side == side2)
@@ -226,6 +247,7 @@ static boolean P_CrossBSPNode_PrBoom(int bspnum)
     {
       register const node_t *bsp = nodes + bspnum;
       int side,side2;
+      sightnodes++;
       side = P_DivlineSide(los.strace.x,los.strace.y,(const divline_t *)bsp)&1;
       side2= P_DivlineSide(los.t2x, los.t2y, (const divline_t *) bsp);
       if (side == side2)
@@ -259,7 +281,7 @@ static boolean P_CrossBSPNode(int bspnum)
 //
 // killough 4/20/98: cleaned up, made to use new LOS struct
 
-boolean P_CheckSight(mobj_t *t1, mobj_t *t2)
+static boolean P_CheckSightUncached(mobj_t *t1, mobj_t *t2)
 {
   const sector_t *s1 = t1->subsector->sector;
   const sector_t *s2 = t2->subsector->sector;
@@ -336,3 +358,32 @@ boolean P_CheckSight(mobj_t *t1, mobj_t *t2)
   // the head node is the last node output
   return P_CrossBSPNode(numnodes-1);
 }
+
+boolean P_CheckSight(mobj_t *t1, mobj_t *t2)
+{
+  sightcache_t *c = &sightcache[((t1->x >> FRACBITS) * 31 + (t1->y >> FRACBITS) * 17 +
+                                 (t2->x >> FRACBITS) * 7 + (t2->y >> FRACBITS)) &
+                                (SIGHTCACHE_SIZE-1)];
+
+  sightchecks++;
+  if (c->gen == sightgen &&
+      c->x1 == t1->x && c->y1 == t1->y && c->z1 == t1->z && c->h1 == t1->height &&
+      c->x2 == t2->x && c->y2 == t2->y && c->z2 == t2->z && c->h2 == t2->height &&
+      c->ss1 == t1->subsector && c->ss2 == t2->subsector)
+    {
+      sightcached++;
+#ifdef RANGECHECK
+      // a hit has to be what looking again gives, or sightgen missed a move
+      if (c->visible != P_CheckSightUncached(t1, t2))
+        I_Error("P_CheckSight: stale cached sight between %d,%d and %d,%d",
+                t1->x >> FRACBITS, t1->y >> FRACBITS, t2->x >> FRACBITS, t2->y >> FRACBITS);
+#endif
+      return c->visible;
+    }
+
+  c->x1 = t1->x; c->y1 = t1->y; c->z1 = t1->z; c->h1 = t1->height;
+  c->x2 = t2->x; c->y2 = t2->y; c->z2 = t2->z; c->h2 = t2->height;
+  c->ss1 = t1->subsector; c->ss2 = t2->subsector;
+  c->gen = sightgen;
+  return c->visible = P_CheckSightUncached(t1, t2);
+}
@@ -2676,6 +2676,7 @@ void T_Scroll(scroll_t *s)
             // non-floating, and clipped.
             thing->momx += dx;
             thing->momy += dy;
+            P_WakeThinker(&thing->thinker);
           }
       break;
 
@@ -2705,7 +2706,7 @@ void T_Scroll(scroll_t *s)
 static void Add_Scroller(int type, fixed_t dx, fixed_t dy,
                          int control, int affectee, int accel)
 {
-  scroll_t *s = Z_Malloc(sizeof *s, PU_LEVSPEC, 0);
+  scroll_t *s = P_AllocThinker(sizeof *s);
   s->thinker.function = T_Scroll;
   s->type = type;
   s->dx = dx;
@@ -2850,7 +2851,7 @@ static void P_SpawnScrollers(void)
 
 static void Add_Friction(int friction, int movefactor, int affectee)
     {
-    friction_t *f = Z_Malloc(sizeof *f, PU_LEVSPEC, 0);
+    friction_t *f = P_AllocThinker(sizeof *f);
 
     f->thinker.function/*.acp1*/ = /*(actionf_p1) */T_Friction;
     f->friction = friction;
@@ -3082,7 +3083,7 @@ static void P_SpawnFriction(void)
 
 static void Add_Pusher(int type, int x_mag, int y_mag, mobj_t* source, int affectee)
     {
-    pusher_t *p = Z_Malloc(sizeof *p, PU_LEVSPEC, 0);
+    pusher_t *p = P_AllocThinker(sizeof *p);
 
     p->thinker.function = T_Pusher;
     p->source = source;
@@ -3154,6 +3155,7 @@ static boolean PIT_PushThing(mobj_t* thing)
           pushangle >>= ANGLETOFINESHIFT;
           thing->momx += FixedMul(speed,finecosine[pushangle]);
           thing->momy += FixedMul(speed,finesine[pushangle]);
+          P_WakeThinker(&thing->thinker);
         }
     }
   return true;
@@ -3283,6 +3285,7 @@ void T_Pusher(pusher_t *p)
             }
         thing->momx += xspeed<<(FRACBITS-PUSH_FACTOR);
         thing->momy += yspeed<<(FRACBITS-PUSH_FACTOR);
+        P_WakeThinker(&thing->thinker);
         }
     }
 
@@ -36,7 +36,14 @@
 #include "p_spec.h"
 #include "p_tick.h"
 #include "p_map.h"
+#include "p_maputl.h"
+#include "p_enemy.h"
 #include "r_fps.h"
+#include "r_main.h"
+#include "w_wad.h"
+#include "i_system.h"
+#include "lprintf.h"
+#include "esp_heap_caps.h"
 
 int leveltime;
 
@@ -44,7 +51,7 @@ static boolean newthinkerpresent;
 
 //
 // THINKERS
-// All thinkers should be allocated by Z_Malloc
+// All thinkers should be allocated by P_AllocThinker
 // so they can be operated on uniformly.
 // The actual structures will vary in size,
 // but the first element must be thinker_t.
@@ -54,6 +61,222 @@ static boolean newthinkerpresent;
 // a special class of thinkers, to allow more efficient searches.
 thinker_t thinkerclasscap[th_all+1];
 
+//
+// Thinker slabs
+//
+// Thinkers are cut from slabs, a set for each size, so the mobjs of a
+// level sit together and so do the specials of each kind, and a run of the
+// thinker list walks through a few slabs instead of all over PSRAM. The
+// list itself, and so the order thinkers run in, doesn't change.
+//
+// The first THINKER_INTERNAL bytes (config.h) of slabs come from internal RAM, the
+// rest are PU_LEVEL zone blocks. A freed thinker goes to the next one of
+// its size. P_FreeThinkerSlabs lets them all go with the level.
+//
+
+#define THINKER_SLAB     (8*1024)
+#define THINKER_SIZES    16
+
+typedef struct thinkerpool_s thinkerpool_t;
+
+typedef struct thinkerslab_s {
+  struct thinkerslab_s *next;
+  thinkerpool_t *pool;
+  byte *start, *end;
+  boolean internal;
+} thinkerslab_t;
+
+struct thinkerpool_s {
+  size_t size;
+  byte *bump, *end;           // rest of the newest slab
+  void *free;                 // freed thinkers, linked through their first word
+};
+
+static thinkerpool_t thinkerpools[THINKER_SIZES];
+static int numthinkerpools;
+static thinkerslab_t *thinkerslabs;
+static size_t internalslabs;
+
+void *P_AllocThinker(size_t size)
+{
+  thinkerpool_t *pool;
+  byte *p;
+
+  size = (size + 7) & ~7;
+  for (pool = thinkerpools; pool < thinkerpools + numthinkerpools; pool++)
+    if (pool->size == size)
+      break;
+  if (pool == thinkerpools + numthinkerpools)
+    {
+      if (numthinkerpools == THINKER_SIZES)
+        return Z_Malloc(size, PU_LEVEL, NULL);
+      pool->size = size;
+      numthinkerpools++;
+    }
+
+  if ((p = pool->free) != NULL)
+    {
+      pool->free = *(void **)p;
+      return p;
+    }
+
+  if (pool->bump + size > pool->end)
+    {
+      size_t slabsize = THINKER_SLAB > size*4 ? THINKER_SLAB : size*4;
+      thinkerslab_t *slab = NULL;
+
+      if (internalslabs + slabsize + sizeof *slab <= THINKER_INTERNAL &&
+          (slab = heap_caps_malloc(slabsize + sizeof *slab, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)))
+        {
+          internalslabs += slabsize + sizeof *slab;
+          slab->internal = true;
+        }
+      else
+        {
+          slab = Z_Malloc(slabsize + sizeof *slab, PU_LEVEL, NULL);
+          slab->internal = false;
+        }
+      slab->pool = pool;
+      slab->start = pool->bump = (byte *)(slab + 1);
+      slab->end = pool->end = pool->bump + slabsize;
+      slab->next = thinkerslabs;
+      thinkerslabs = slab;
+    }
+
+  p = pool->bump;
+  pool->bump += size;
+  return p;
+}
+
+void P_FreeThinker(thinker_t *thinker)
+{
+  thinkerslab_t *slab;
+
+  for (slab = thinkerslabs; slab; slab = slab->next)
+    if ((byte *)thinker >= slab->start && (byte *)thinker < slab->end)
+      {
+        *(void **)thinker = slab->pool->free;
+        slab->pool->free = thinker;
+        return;
+      }
+  Z_Free(thinker);            // there were too many sizes
+}
+
+//
+// P_FreeThinkerSlabs
+// Called by P_SetupLevel just before Z_FreeTags. The slab list runs
+// through the zone slabs too, so it has to be walked while they are
+// still there; this frees the internal slabs and leaves the zone ones
+// to Z_FreeTags.
+//
+
+void P_FreeThinkerSlabs(void)
+{
+  while (thinkerslabs)
+    {
+      thinkerslab_t *next = thinkerslabs->next;
+      if (thinkerslabs->internal)
+        heap_caps_free(thinkerslabs);
+      thinkerslabs = next;
+    }
+  memset(thinkerpools, 0, sizeof thinkerpools);
+  numthinkerpools = 0;
+  internalslabs = 0;
+}
+
+//
+// killough 11/98:
+//
+// Make currentthinker external, so that P_RemoveThinkerDelayed
+// can adjust currentthinker when thinkers self-remove.
+
+static thinker_t *currentthinker;
+
+//
+// Dormant thinkers
+//
+// A monster waiting in A_Look, or a light between flashes, spends most
+// tics just counting down. With dormant_thinkers on, P_SleepThinker takes
+// such a thinker out of the ring of awake ones that P_RunThinkers walks,
+// and files it in the wake wheel under the tic its count runs out on.
+// P_WakeThinker puts it back at the end of the ring, either then or sooner
+// when something acts on it, with the count it would have got down to.
+//
+// Woken thinkers run in a different place in the ring than they were
+// added in, and that order reaches P_Random, so demos and netgames always
+// run the whole list in order with everything awake.
+//
+
+#define WAKE_SLOTS 64         // power of two; longer sleeps wait a lap
+
+int dormant_thinkers;
+
+static thinker_t awakecap;    // ring of awake thinkers
+static thinker_t wakewheel[WAKE_SLOTS];
+static boolean runawake;      // P_RunThinkers is walking the awake ring
+static int runtic;            // leveltime the next thinking happens in
+static int sleepers, asleep;
+
+static void P_LinkAwake(thinker_t *thinker, thinker_t *cap)
+{
+  cap->aprev->anext = thinker;
+  thinker->anext = cap;
+  thinker->aprev = cap->aprev;
+  cap->aprev = thinker;
+}
+
+static void P_UnlinkAwake(thinker_t *thinker)
+{
+  (thinker->anext->aprev = thinker->aprev)->anext = thinker->anext;
+}
+
+void P_SleepThinker(thinker_t *thinker, int *count)
+{
+  if (!runawake || *count <= 1)
+    return;
+
+  // Thinking again on tic wake, the count has to be 1 before it's dropped
+  thinker->wake = runtic + *count;
+  thinker->countdown = count;
+  if (currentthinker == thinker)
+    currentthinker = thinker->aprev;
+  P_UnlinkAwake(thinker);
+  P_LinkAwake(thinker, &wakewheel[thinker->wake & (WAKE_SLOTS-1)]);
+  sleepers++;
+}
+
+void P_WakeThinker(thinker_t *thinker)
+{
+  if (!thinker->wake)
+    return;
+  *thinker->countdown = thinker->wake - runtic + 1;
+  thinker->wake = 0;
+  P_UnlinkAwake(thinker);
+  P_LinkAwake(thinker, &awakecap);
+  sleepers--;
+}
+
+void P_WakeThinkers(void)
+{
+  int i;
+
+  for (i=0; sleepers && i<WAKE_SLOTS; i++)
+    while (wakewheel[i].anext != &wakewheel[i])
+      P_WakeThinker(wakewheel[i].anext);
+}
+
+static void P_WakeDueThinkers(void)
+{
+  thinker_t *slot = &wakewheel[runtic & (WAKE_SLOTS-1)], *th, *next;
+
+  for (th = slot->anext; th != slot; th = next)
+    {
+      next = th->anext;
+      if (th->wake == runtic)
+        P_WakeThinker(th);
+    }
+}
+
 //
 // P_InitThinkers
 //
@@ -66,6 +289,11 @@ void P_InitThinkers(void)
     thinkerclasscap[i].cprev = thinkerclasscap[i].cnext = &thinkerclasscap[i];
 
   thinkercap.prev = thinkercap.next  = &thinkercap;
+
+  awakecap.aprev = awakecap.anext = &awakecap;
+  for (i=0; i<WAKE_SLOTS; i++)
+    wakewheel[i].aprev = wakewheel[i].anext = &wakewheel[i];
+  sleepers = 0;
 }
 
 //
@@ -117,20 +345,15 @@ void P_AddThinker(thinker_t* thinker)
 
   thinker->references = 0;    // killough 11/98: init reference counter to 0
 
+  thinker->wake = 0;
+  P_LinkAwake(thinker, &awakecap);
+
   // killough 8/29/98: set sentinel pointers, and then add to appropriate list
   thinker->cnext = thinker->cprev = NULL;
   P_UpdateThinker(thinker);
   newthinkerpresent = true;
 }
 
-//
-// killough 11/98:
-//
-// Make currentthinker external, so that P_RemoveThinkerDelayed
-// can adjust currentthinker when thinkers self-remove.
-
-static thinker_t *currentthinker;
-
 //
 // P_RemoveThinkerDelayed()
 //
@@ -159,7 +382,11 @@ void P_RemoveThinkerDelayed(thinker_t *thinker)
         thinker_t *th = thinker->cnext;
         (th->cprev = thinker->cprev)->cnext = th;
       }
-      Z_Free(thinker);
+      /* And from the awake ring, which may be the one being walked */
+      if (runawake)
+        currentthinker = thinker->aprev;
+      P_UnlinkAwake(thinker);
+      P_FreeThinker(thinker);
     }
 }
 
@@ -179,6 +406,7 @@ void P_RemoveThinkerDelayed(thinker_t *thinker)
 void P_RemoveThinker(thinker_t *thinker)
 {
   R_StopInterpolationIfNeeded(thinker);
+  P_WakeThinker(thinker);     // so it gets its turn to be freed
   thinker->function = P_RemoveThinkerDelayed;
 
   P_UpdateThinker(thinker);
@@ -240,16 +468,58 @@ void P_SetTarget(mobj_t **mop, mobj_t *targ)
 
 static void P_RunThinkers (void)
 {
-  for (currentthinker = thinkercap.next;
-       currentthinker != &thinkercap;
-       currentthinker = currentthinker->next)
+  static unsigned long total, worst;
+  static int tics, count;
+  unsigned long starttime = I_GetTimeUS(), time;
+
+  runtic = leveltime;
+  runawake = dormant_thinkers && !demorecording && !demoplayback && !netgame;
+  if (runawake)
+    P_WakeDueThinkers();
+  else
+    P_WakeThinkers();
+
+  for (currentthinker = runawake ? awakecap.anext : thinkercap.next;
+       currentthinker != (runawake ? &awakecap : &thinkercap);
+       currentthinker = runawake ? currentthinker->anext : currentthinker->next)
   {
     if (newthinkerpresent)
       R_ActivateThinkerInterpolations(currentthinker);
     if (currentthinker->function)
       currentthinker->function(currentthinker);
+    count++;
   }
   newthinkerpresent = false;
+  runawake = false;
+  runtic = leveltime + 1;
+  asleep += sleepers;
+
+  // Thinker time per tic, logged every 10 seconds with the rendering stats
+  time = I_GetTimeUS() - starttime;
+  total += time;
+  if (time > worst)
+    worst = time;
+  if (++tics == 10*TICRATE)
+  {
+    if (rendering_stats)
+      lprintf(LO_INFO, "P_RunThinkers: avg %luus, max %luus, %d thinkers (%d asleep), %u P_CheckPositions, "
+              "%u sight checks (%u cached, %u BSP nodes), %u hitscans (%u/ms), %u intercepts, "
+              "%u sector lists (%u kept, %u nodes got), %u noise alerts in 10s (%luus each), "
+              "%uKB slabs in internal RAM\n",
+              total / tics, worst, count / tics, asleep / tics, checkpositions / tics,
+              sightchecks / tics, sightcached / tics, sightnodes / tics,
+              hitscans / tics, hitscanus ? (unsigned)(hitscans * 1000ull / hitscanus) : 0,
+              interceptcount / tics,
+              secnodelists / tics, secnodeskept / tics, secnodesmade / tics,
+              noisealerts, noisealerts ? noisealertus / noisealerts : 0,
+              (unsigned)(internalslabs / 1024));
+    total = worst = tics = count = asleep = 0;
+    checkpositions = sightchecks = sightcached = sightnodes = 0;
+    hitscans = interceptcount = 0;
+    secnodelists = secnodeskept = secnodesmade = noisealerts = 0;
+    noisealertus = 0;
+    hitscanus = 0;
+  }
 }
 
 //
@@ -287,5 +557,9 @@ void P_Ticker (void)
   P_RespawnSpecials();
   P_MapEnd();
   leveltime++;                       // for par times
+
+  // lumps that have become hot since the level started, 16K at a time
+  if (!(leveltime % (10*TICRATE)))
+    W_PromoteHotLumps(16*1024);
 }
 
@@ -41,19 +41,19 @@
 #include "v_video.h"
 #include "lprintf.h"
 
-seg_t     *curline;
-side_t    *sidedef;
-line_t    *linedef;
-sector_t  *frontsector;
-sector_t  *backsector;
-drawseg_t *ds_p;
+R_LOCAL seg_t     *curline;
+R_LOCAL side_t    *sidedef;
+R_LOCAL line_t    *linedef;
+R_LOCAL sector_t  *frontsector;
+R_LOCAL sector_t  *backsector;
+R_LOCAL drawseg_t *ds_p;
 
 // killough 4/7/98: indicates doors closed wrt automap bugfix:
 // cph - replaced by linedef rendering flags - int      doorclosed;
 
 // killough: New code which removes 2s linedef limit
-drawseg_t *drawsegs;
-unsigned  maxdrawsegs;
+R_LOCAL drawseg_t *drawsegs;
+R_LOCAL unsigned  maxdrawsegs;
 // drawseg_t drawsegs[MAXDRAWSEGS];       // old code -- killough
 
 //
@@ -68,8 +68,72 @@ void R_ClearDrawSegs(void)
 // CPhipps -
 // Instead of clipsegs, let's try using an array with one entry for each column,
 // indicating whether it's blocked by a solid wall yet or not.
+//
+// Now a bit per column, so runs of covered columns are passed over a word
+// at a time, and full words are passed over using solidcolsum. Columns
+// outside the thread's part of the view start out solid, so the whole
+// view is covered once solidcolsum is SOLIDCOL_FULL.
+
+#if SOLIDCOL_WORDS > 32
+#error solidcolsum needs a bit for each word of solidcol
+#endif
+
+unsigned solidcol[RENDER_THREADS][SOLIDCOL_WORDS];
+R_LOCAL unsigned solidcolsum;
+
+// The bits of word w for columns first..last-1, which overlap it
+static inline unsigned R_ColMask(int w, int first, int last)
+{
+  unsigned mask = ~0u;
+
+  if (first > w*32)
+    mask <<= first - w*32;
+  if (last < w*32 + 32)
+    mask &= ~0u >> (w*32 + 32 - last);
+  return mask;
+}
+
+void R_SetSolidCols(int first, int last)
+{
+  unsigned *cols = solidcol[renderthread];
+  int w;
+
+  for (w = first >> 5; w <= (last-1) >> 5; w++)
+    if ((cols[w] |= R_ColMask(w, first, last)) == ~0u)
+      solidcolsum |= 1u << w;
+}
+
+// The first column from first, and before last, that is solid, or isn't
+// solid if !solid. last if there's none.
+static int R_FindCol(int first, int last, boolean solid)
+{
+  const unsigned *cols = solidcol[renderthread];
+  int w;
+  unsigned bits;
 
-byte solidcol[MAX_SCREENWIDTH];
+  if (first >= last)   // first may be the screen width, past the last word
+    return last;
+  w = first >> 5;
+  bits = (solid ? cols[w] : ~cols[w]) & (~0u << (first & 31));
+
+  while (!bits)
+    {
+      if (++w << 5 >= last)
+        return last;
+      if (!solid)
+        {
+          unsigned open = ~solidcolsum & SOLIDCOL_FULL & (~0u << w);
+          if (!open)
+            return last;
+          w = __builtin_ctz(open);
+          if (w << 5 >= last)
+            return last;
+        }
+      bits = solid ? cols[w] : ~cols[w];
+    }
+  first = (w << 5) + __builtin_ctz(bits);
+  return first < last ? first : last;
+}
 
 // CPhipps -
 // R_ClipWallSegment
@@ -79,21 +143,12 @@ byte solidcol[MAX_SCREENWIDTH];
 
 static void R_ClipWallSegment(int first, int last, boolean solid)
 {
-  byte *p;
-  while (first < last) {
-    if (solidcol[first]) {
-      if (!(p = memchr(solidcol+first, 0, last-first))) return; // All solid
-      first = p - solidcol;
-    } else {
-      int to;
-      if (!(p = memchr(solidcol+first, 1, last-first))) to = last;
-      else to = p - solidcol;
-      R_StoreWallRange(first, to-1);
-      if (solid) {
-  memset(solidcol+first,1,to-first);
-      }
-  first = to;
-    }
+  while ((first = R_FindCol(first, last, false)) < last) {
+    int to = R_FindCol(first, last, true);
+    R_StoreWallRange(first, to-1);
+    if (solid)
+      R_SetSolidCols(first, to);
+    first = to;
   }
 }
 
@@ -103,7 +158,17 @@ static void R_ClipWallSegment(int first, int last, boolean solid)
 
 void R_ClearClipSegs (void)
 {
-  memset(solidcol, 0, SCREENWIDTH);
+  unsigned *cols = solidcol[renderthread];
+  int w;
+
+  for (w = 0; w < SOLIDCOL_WORDS; w++)
+    cols[w] = ~0u;
+  solidcolsum = SOLIDCOL_FULL;
+  for (w = viewstartx >> 5; w <= (viewstopx-1) >> 5; w++)
+    {
+      cols[w] &= ~R_ColMask(w, viewstartx, viewstopx);
+      solidcolsum &= ~(1u << w);
+    }
 }
 
 // killough 1/18/98 -- This function is used to fix the automap bug which
@@ -112,9 +177,9 @@ void R_ClearClipSegs (void)
 // cph - converted to R_RecalcLineFlags. This recalculates all the flags for
 // a line, including closure and texture tiling.
 
-static void R_RecalcLineFlags(void)
+static int R_LineFlags(void)
 {
-  linedef->r_validcount = gametic;
+  int r_flags;
 
   /* First decide if the line is closed, normal, or invisible */
   if (!(linedef->flags & ML_TWOSIDED)
@@ -136,7 +201,7 @@ static void R_RecalcLineFlags(void)
         frontsector->ceilingpic!=skyflatnum)
     )
       )
-    linedef->r_flags = RF_CLOSED;
+    r_flags = RF_CLOSED;
   else {
     // Reject empty lines used for triggers
     //  and special events.
@@ -153,13 +218,13 @@ static void R_RecalcLineFlags(void)
       sizeof(frontsector->ceilingpic) + sizeof(frontsector->floorpic) +
       sizeof(frontsector->lightlevel) + sizeof(frontsector->floorlightsec) +
       sizeof(frontsector->ceilinglightsec))) {
-      linedef->r_flags = 0; return;
+      return 0;
     } else
-      linedef->r_flags = RF_IGNORE;
+      r_flags = RF_IGNORE;
   }
 
   /* cph - I'm too lazy to try and work with offsets in this */
-  if (curline->sidedef->rowoffset) return;
+  if (curline->sidedef->rowoffset) return r_flags;
 
   /* Now decide on texture tiling */
   if (linedef->flags & ML_TWOSIDED) {
@@ -168,19 +233,28 @@ static void R_RecalcLineFlags(void)
     /* Does top texture need tiling */
     if ((c = frontsector->ceilingheight - backsector->ceilingheight) > 0 &&
    (textureheight[texturetranslation[curline->sidedef->toptexture]] > c))
-      linedef->r_flags |= RF_TOP_TILE;
+      r_flags |= RF_TOP_TILE;
 
     /* Does bottom texture need tiling */
     if ((c = frontsector->floorheight - backsector->floorheight) > 0 &&
    (textureheight[texturetranslation[curline->sidedef->bottomtexture]] > c))
-      linedef->r_flags |= RF_BOT_TILE;
+      r_flags |= RF_BOT_TILE;
   } else {
     int c;
     /* Does middle texture need tiling */
     if ((c = frontsector->ceilingheight - frontsector->floorheight) > 0 &&
    (textureheight[texturetranslation[curline->sidedef->midtexture]] > c))
-      linedef->r_flags |= RF_MID_TILE;
+      r_flags |= RF_MID_TILE;
   }
+  return r_flags;
+}
+
+/* The flags are complete before r_validcount says so, as with
+ * SPLIT_RENDER the other render thread may be looking at the line */
+static void R_RecalcLineFlags(void)
+{
+  linedef->r_flags = R_LineFlags();
+  linedef->r_validcount = gametic;
 }
 
 //
@@ -300,7 +374,7 @@ static void R_AddLine (seg_t *line)
   angle_t  angle2;
   angle_t  span;
   angle_t  tspan;
-  static sector_t tempsec;     // killough 3/8/98: ceiling/water hack
+  static R_LOCAL sector_t tempsec; // killough 3/8/98: ceiling/water hack
 
   curline = line;
 
@@ -356,6 +430,11 @@ static void R_AddLine (seg_t *line)
   x1 = viewangletox[angle1];
   x2 = viewangletox[angle2];
 
+  // The whole seg's columns, before this thread's part of the view or
+  // solid walls clip them, for R_StoreWallRange to step from
+  rw_segx1 = x1;
+  rw_segx2 = x2-1;
+
 //	ets_printf("a1 %d x1 %d a2 %d x2 %d\n", angle1, x1, angle2, x2);
 
 
@@ -384,6 +463,12 @@ static void R_AddLine (seg_t *line)
       return;
   }
 #else
+  // Only this render thread's columns
+  if (x1 < viewstartx)
+    x1 = viewstartx;
+  if (x2 > viewstopx)
+    x2 = viewstopx;
+
   // Does not cross a pixel?
   if (x1 >= x2)       // killough 1/31/98 -- change == to >= for robustness
     return;
@@ -479,11 +564,16 @@ static boolean R_CheckBBox(const fixed_t *bspcoord)
     int sx2 = viewangletox[angle2];
     //    const cliprange_t *start;
 
+    if (sx1 < viewstartx)
+      sx1 = viewstartx;
+    if (sx2 > viewstopx)
+      sx2 = viewstopx;
+
     // Does not cross a pixel.
-    if (sx1 == sx2)
+    if (sx1 >= sx2)
       return false;
 
-    if (!memchr(solidcol+sx1, 0, sx2-sx1)) return false;
+    if (R_FindCol(sx1, sx2, false) == sx2) return false;
     // All columns it covers are already solidly covered
   }
 
@@ -658,12 +748,18 @@ void R_RenderBSPNode(int bspnum)
 
       // Decide which side the view point is on.
       int side = R_PointOnSide(viewx, viewy, bsp);
+
+      rendered_nodes++;
+
       // Recursively divide front space.
       R_RenderBSPNode(bsp->children[side]);
 
       // Possibly divide back space.
+      // Once every column is solid, R_CheckBBox would turn down this and
+      // every back space still to come, so the walk unwinds without
+      // testing them. Front spaces are always walked in full.
 
-      if (!R_CheckBBox(bsp->bbox[side^1]))
+      if (solidcolsum == SOLIDCOL_FULL || !R_CheckBBox(bsp->bbox[side^1]))
         return;
 
       bspnum = bsp->children[side^1];
@@ -42,6 +42,7 @@
 #include "r_things.h"
 #include "p_tick.h"
 #include "lprintf.h"  // jff 08/03/98 - declaration of lprintf
+#include "d_snapshot.h"
 #include "p_tick.h"
 
 //
@@ -109,12 +110,11 @@ const byte *R_GetTextureColumn(const rpatch_t *texpatch, int col) {
 }
 
 //
-// R_InitTextures
-// Initializes the texture list
-//  with the textures from the world map.
+// R_ReadTextures
+// Builds the texture list from TEXTURE1/2 and PNAMES.
 //
 
-static void R_InitTextures (void)
+static void R_ReadTextures (void)
 {
   const maptexture_t *mtexture;
   texture_t    *texture;
@@ -194,7 +194,6 @@ static void R_InitTextures (void)
   // clean up malloc-ing to use sizeof
 
   textures = Z_Malloc(numtextures*sizeof*textures, PU_STATIC, 0);
-  textureheight = Z_Malloc(numtextures*sizeof*textureheight, PU_STATIC, 0);
 
   totalwidth = 0;
 
@@ -281,7 +280,6 @@ static void R_InitTextures (void)
       for (j=1; j*2 <= texture->width; j<<=1)
         ;
       texture->widthmask = j-1;
-      textureheight[i] = texture->height<<FRACBITS;
 
       totalwidth += texture->width;
     }
@@ -295,6 +293,35 @@ static void R_InitTextures (void)
   if (errors)
     I_Error("R_InitTextures: %d errors", errors);
 
+  // killough 1/31/98: Initialize texture hash table
+  for (i = 0; i<numtextures; i++)
+    textures[i]->index = -1;
+  while (--i >= 0)
+    {
+      int j = W_LumpNameHash(textures[i]->name) % (unsigned) numtextures;
+      textures[i]->next = textures[j]->index;   // Prepend to chain
+      textures[j]->index = i;
+    }
+}
+
+//
+// R_InitTextures
+// Initializes the texture list
+//  with the textures from the world map.
+//
+
+static void R_InitTextures (void)
+{
+  int i;
+
+  // The list as it was read on an earlier boot, if the wads are the same
+  if (!D_SnapshotTextures())
+    R_ReadTextures();
+
+  textureheight = Z_Malloc(numtextures*sizeof*textureheight, PU_STATIC, 0);
+  for (i=0 ; i<numtextures ; i++)
+    textureheight[i] = textures[i]->height<<FRACBITS;
+
   // Precalculate whatever possible.
   if (devparm) // cph - If in development mode, generate now so all errors are found at once
     for (i=0 ; i<numtextures ; i++)
@@ -304,9 +331,6 @@ static void R_InitTextures (void)
       R_UnlockTextureCompositePatchNum(i);
     }
 
-  if (errors)
-    I_Error("R_InitTextures: %d errors", errors);
-
   // Create translation table for global animation.
   // killough 4/9/98: make column offsets 32-bit;
   // clean up malloc-ing to use sizeof
@@ -316,16 +340,6 @@ static void R_InitTextures (void)
 
   for (i=0 ; i<numtextures ; i++)
     texturetranslation[i] = i;
-
-  // killough 1/31/98: Initialize texture hash table
-  for (i = 0; i<numtextures; i++)
-    textures[i]->index = -1;
-  while (--i >= 0)
-    {
-      int j = W_LumpNameHash(textures[i]->name) % (unsigned) numtextures;
-      textures[i]->next = textures[j]->index;   // Prepend to chain
-      textures[j]->index = i;
-    }
 }
 
 //
@@ -379,9 +393,10 @@ static void R_InitColormaps(void)
   lastcolormaplump  = W_GetNumForName("C_END");
   numcolormaps = lastcolormaplump - firstcolormaplump;
   colormaps = Z_Malloc(sizeof(*colormaps) * numcolormaps, PU_STATIC, 0);
-  colormaps[0] = (const lighttable_t *)W_CacheLumpName("COLORMAP");
+  // Looked up for every pixel drawn, so into internal RAM if they fit
+  colormaps[0] = (const lighttable_t *)W_PinLumpNum(W_GetNumForName("COLORMAP"));
   for (i=1; i<numcolormaps; i++)
-    colormaps[i] = (const lighttable_t *)W_CacheLumpNum(i+firstcolormaplump);
+    colormaps[i] = (const lighttable_t *)W_PinLumpNum(i+firstcolormaplump);
   // cph - always lock
 }
 
@@ -451,6 +466,55 @@ int tran_filter_pct = 66;       // filter percent
 
 #define TSC 12        /* number of fixed point digits in filter percent */
 
+// The nearest colour search only tries the palette entries that can be
+// nearest to some colour in the same cell of a colour cube, 16 cells a
+// side: those no further from the cell than the smallest distance within
+// which some entry covers all of it. Cells are filled in as they are hit.
+// Gives the same map as trying them all, several times faster.
+#define TRANCUBE_BITS  4
+#define TRANCUBE_SHIFT (8-TRANCUBE_BITS)
+
+static int R_TranCubeCandidates(long pal[3][256], int cell, byte *out)
+{
+  long lo[3], dmin[256], best = LONG_MAX;
+  int c, k, n = 0;
+
+  lo[0] = (cell >> (2*TRANCUBE_BITS)) << TRANCUBE_SHIFT;
+  lo[1] = ((cell >> TRANCUBE_BITS) & ((1<<TRANCUBE_BITS)-1)) << TRANCUBE_SHIFT;
+  lo[2] = (cell & ((1<<TRANCUBE_BITS)-1)) << TRANCUBE_SHIFT;
+
+  for (c=0; c<256; c++)
+    {
+      long dn = 0, dx = 0;
+      for (k=0; k<3; k++)
+        {
+          long below = lo[k] - pal[k][c];
+          long above = pal[k][c] - (lo[k] + (1<<TRANCUBE_SHIFT));
+          if (below > 0)
+            dn += below*below;
+          else if (above > 0)
+            dn += above*above;
+          below = -below > -above ? -below : -above;  // farthest edge
+          dx += below*below;
+        }
+      dmin[c] = dn;
+      if (dx < best)
+        best = dx;
+    }
+
+  // Same order as the full search, so ties go the same way
+  for (c=255; c>=0; c--)
+    if (dmin[c] <= best)
+      out[n++] = c;
+  return n;
+}
+
+// The map built from PLAYPAL is saved as cache_tranmap under this key
+typedef struct {
+  unsigned char pct;
+  unsigned char playpal[256*3];
+} tranmapkey_t;
+
 void R_InitTranMap(int progress)
 {
   int lump = W_CheckNumForName("TRANMAP");
@@ -462,28 +526,29 @@ void R_InitTranMap(int progress)
   else if (W_CheckNumForName("PLAYPAL")!=-1) // can be called before WAD loaded
     {   // Compose a default transparent filter map based on PLAYPAL.
       const byte *playpal = W_CacheLumpName("PLAYPAL");
-      byte       *my_tranmap;
+      unsigned long starttime = I_GetTimeUS();
+      tranmapkey_t key;
+      size_t size;
 
-      char fname[PATH_MAX+1];
-      struct {
-        unsigned char pct;
-        unsigned char playpal[256];
-      } cache;
-      FILE *cachefp = NULL; //fopen(strcat(strcpy(fname, I_DoomExeDir()), "/tranmap.dat"),"rb");
+      memset(&key, 0, sizeof key);
+      key.pct = tran_filter_pct;
+      memcpy(key.playpal, playpal, sizeof key.playpal);
 
-      main_tranmap = my_tranmap = Z_Malloc(256*256, PU_STATIC, 0);  // killough 4/11/98
+      // Use the map saved on an earlier run if it's available
 
-      // Use cached translucency filter if it's available
-
-      if (!cachefp ||
-          fread(&cache, 1, sizeof cache, cachefp) != sizeof cache ||
-          cache.pct != tran_filter_pct ||
-          memcmp(cache.playpal, playpal, sizeof cache.playpal) ||
-          fread(my_tranmap, 256, 256, cachefp) != 256 ) // killough 4/11/98
+      if ((main_tranmap = I_GetCachedData(cache_tranmap, &key, sizeof key, &size)) != NULL &&
+          size == 256*256)
+        lprintf(LO_INFO, "Tranmap cached (%lums) ", (I_GetTimeUS() - starttime) / 1000);
+      else
         {
+          byte *my_tranmap = Z_Malloc(256*256, PU_STATIC, 0);  // killough 4/11/98
+          const byte *cached;
           long pal[3][256], tot[256], pal_w1[3][256];
           long w1 = ((unsigned long) tran_filter_pct<<TSC)/100;
           long w2 = (1l<<TSC)-w1;
+          int *cubepos = Z_Calloc(1<<(3*TRANCUBE_BITS), sizeof *cubepos, PU_STATIC, 0);
+          byte *cands = NULL;
+          int ncands = 0, maxcands = 0;
 
           if (progress)
             lprintf(LO_INFO, "Tranmap build [        ]\x08\x08\x08\x08\x08\x08\x08\x08\x08");
@@ -524,35 +589,56 @@ void R_InitTranMap(int progress)
                   lprintf(LO_INFO,".");
                 for (j=0;j<256;j++,tp++)
                   {
-                    register int color = 255;
                     register long err;
                     long r = pal_w1[0][j] + r1;
                     long g = pal_w1[1][j] + g1;
                     long b = pal_w1[2][j] + b1;
                     long best = LONG_MAX;
+                    int cell = (r >> (TSC+TRANCUBE_SHIFT) << (2*TRANCUBE_BITS)) |
+                               (g >> (TSC+TRANCUBE_SHIFT) << TRANCUBE_BITS) |
+                               (b >> (TSC+TRANCUBE_SHIFT));
+                    const byte *cand;
+                    int n;
+
+                    // A cell's candidates are kept as their count less one,
+                    // then the colours
+                    if (!cubepos[cell])
+                      {
+                        if (ncands + 257 > maxcands)
+                          cands = Z_Realloc(cands, maxcands += 16384, PU_STATIC, 0);
+                        n = R_TranCubeCandidates(pal, cell, cands + ncands + 1);
+                        cands[ncands] = n - 1;
+                        cubepos[cell] = ncands + 1;
+                        ncands += n + 1;
+                      }
+                    cand = cands + cubepos[cell] - 1;
+                    n = *cand++ + 1;
                     do
-                      if ((err = tot[color] - pal[0][color]*r
-                          - pal[1][color]*g - pal[2][color]*b) < best)
-                        best = err, *tp = color;
-                    while (--color >= 0);
+                      {
+                        register int color = *cand++;
+                        if ((err = tot[color] - pal[0][color]*r
+                            - pal[1][color]*g - pal[2][color]*b) < best)
+                          best = err, *tp = color;
+                      }
+                    while (--n);
                   }
               }
           }
-          //if ((cachefp = fopen(fname,"wb")) != NULL) // write out the cached translucency map
-			if(0) 
+          Z_Free(cands);
+          Z_Free(cubepos);
+
+          lprintf(LO_INFO, " (%lums) ", (I_GetTimeUS() - starttime) / 1000);
+
+          // Save it for next time, and read it in place from there
+          if ((cached = I_CacheData(cache_tranmap, &key, sizeof key, my_tranmap, 256*256)) != NULL)
             {
-              cache.pct = tran_filter_pct;
-              memcpy(cache.playpal, playpal, 256);
-              fseek(cachefp, 0, SEEK_SET);
-              fwrite(&cache, 1, sizeof cache, cachefp);
-              fwrite(main_tranmap, 256, 256, cachefp);
-              // CPhipps - leave close for a few lines...
+              Z_Free(my_tranmap);
+              main_tranmap = cached;
             }
+          else
+            main_tranmap = my_tranmap;
         }
 
-      if (cachefp)              // killough 11/98: fix filehandle leak
-        fclose(cachefp);
-
       W_UnlockLumpName("PLAYPAL");
     }
 }
@@ -66,7 +66,7 @@ int  viewwindowy;
 //
 
 // CPhipps - made const*'s
-const byte *tranmap;          // translucency filter maps 256x256   // phares
+R_LOCAL const byte *tranmap;  // translucency filter maps 256x256   // phares
 const byte *main_tranmap;     // killough 4/11/98
 
 //
@@ -85,17 +85,17 @@ typedef enum
    COL_FLEXADD
 } columntype_e;
 
-static int    temp_x = 0;
-static int    tempyl[4], tempyh[4];
-static byte           byte_tempbuf[MAX_SCREENHEIGHT * 4];
-static unsigned short short_tempbuf[MAX_SCREENHEIGHT * 4];
-static unsigned int   int_tempbuf[MAX_SCREENHEIGHT * 4];
-static int    startx = 0;
-static int    temptype = COL_NONE;
-static int    commontop, commonbot;
-static const byte *temptranmap = NULL;
+static R_LOCAL int    temp_x = 0;
+static R_LOCAL int    tempyl[4], tempyh[4];
+static byte           byte_tempbuf[RENDER_THREADS][MAX_SCREENHEIGHT * 4];
+static unsigned short short_tempbuf[RENDER_THREADS][MAX_SCREENHEIGHT * 4];
+static unsigned int   int_tempbuf[RENDER_THREADS][MAX_SCREENHEIGHT * 4];
+static R_LOCAL int    startx = 0;
+static R_LOCAL int    temptype = COL_NONE;
+static R_LOCAL int    commontop, commonbot;
+static R_LOCAL const byte *temptranmap = NULL;
 // SoM 7-28-04: Fix the fuzz problem.
-static const byte   *tempfuzzmap;
+static R_LOCAL const byte   *tempfuzzmap;
 
 //
 // Spectre/Invisibility.
@@ -118,7 +118,7 @@ static const int fuzzoffset_org[FUZZTABLE] = {
 
 static int fuzzoffset[FUZZTABLE];
 
-static int fuzzpos = 0;
+static R_LOCAL int fuzzpos = 0;
 
 // render pipelines
 #define RDC_STANDARD      1
@@ -153,6 +153,10 @@ draw_vars_t drawvars = {
   49152 // mag_threshold
 };
 
+#ifdef PIPELINE_RENDER
+R_LOCAL draw_vars_t *drawtarget = &drawvars;
+#endif
+
 //
 // Error functions that will abort if R_FlushColumns tries to flush 
 // columns without a column type.
@@ -173,9 +177,9 @@ static void R_QuadFlushError(void)
    I_Error("R_FlushQuadColumn called without being initialized.\n");
 }
 
-static void (*R_FlushWholeColumns)(void) = R_FlushWholeError;
-static void (*R_FlushHTColumns)(void)    = R_FlushHTError;
-static void (*R_FlushQuadColumn)(void) = R_QuadFlushError;
+static R_LOCAL void (*R_FlushWholeColumns)(void) = R_FlushWholeError;
+static R_LOCAL void (*R_FlushHTColumns)(void)    = R_FlushHTError;
+static R_LOCAL void (*R_FlushQuadColumn)(void) = R_QuadFlushError;
 
 static void R_FlushColumns(void)
 {
@@ -1005,25 +1009,60 @@ void R_InitBuffer(int width, int height)
 
   viewwindowy = width==SCREENWIDTH ? 0 : (SCREENHEIGHT-(ST_SCALED_HEIGHT-1)-height)>>1;
 
-  drawvars.byte_topleft = screens[0].data + viewwindowy*screens[0].byte_pitch + viewwindowx;
-  drawvars.short_topleft = (unsigned short *)(screens[0].data) + viewwindowy*screens[0].short_pitch + viewwindowx;
-  drawvars.int_topleft = (unsigned int *)(screens[0].data) + viewwindowy*screens[0].int_pitch + viewwindowx;
+  R_RebaseBuffer();
   drawvars.byte_pitch = screens[0].byte_pitch;
   drawvars.short_pitch = screens[0].short_pitch;
   drawvars.int_pitch = screens[0].int_pitch;
 
   if (V_GetMode() == VID_MODE8) {
     for (i=0; i<FUZZTABLE; i++)
-      fuzzoffset[i] = fuzzoffset_org[i]*screens[0].byte_pitch;
+      fuzzoffset[i] = fuzzoffset_org[i]*V_YSTEP(screens[0].byte_pitch);
   } else if ((V_GetMode() == VID_MODE15) || (V_GetMode() == VID_MODE16)) {
     for (i=0; i<FUZZTABLE; i++)
-      fuzzoffset[i] = fuzzoffset_org[i]*screens[0].short_pitch;
+      fuzzoffset[i] = fuzzoffset_org[i]*V_YSTEP(screens[0].short_pitch);
   } else if (V_GetMode() == VID_MODE32) {
     for (i=0; i<FUZZTABLE; i++)
-      fuzzoffset[i] = fuzzoffset_org[i]*screens[0].int_pitch;
+      fuzzoffset[i] = fuzzoffset_org[i]*V_YSTEP(screens[0].int_pitch);
   }
 }
 
+//
+// R_RebaseBuffer
+// Recomputes the view window pointers after screens[0].data moved,
+//  e.g. when the video code flipped to another framebuffer.
+//
+
+void R_RebaseBuffer(void)
+{
+  drawvars.byte_topleft = screens[0].data + V_PIXOFS(viewwindowx, viewwindowy, screens[0].byte_pitch);
+  drawvars.short_topleft = (unsigned short *)(screens[0].data) + V_PIXOFS(viewwindowx, viewwindowy, screens[0].short_pitch);
+  drawvars.int_topleft = (unsigned int *)(screens[0].data) + V_PIXOFS(viewwindowx, viewwindowy, screens[0].int_pitch);
+}
+
+#ifdef PIPELINE_RENDER
+//
+// R_SetViewTarget
+// Has this thread draw the view into screen, a framebuffer laid out like
+// screens[0], or back into screens[0] if screen is NULL.
+//
+
+void R_SetViewTarget(byte *screen)
+{
+  static R_LOCAL draw_vars_t target;
+
+  if (!screen)
+    {
+      drawtarget = &drawvars;
+      return;
+    }
+  target = drawvars;
+  target.byte_topleft = screen + V_PIXOFS(viewwindowx, viewwindowy, screens[0].byte_pitch);
+  target.short_topleft = (unsigned short *)screen + V_PIXOFS(viewwindowx, viewwindowy, screens[0].short_pitch);
+  target.int_topleft = (unsigned int *)screen + V_PIXOFS(viewwindowx, viewwindowy, screens[0].int_pitch);
+  drawtarget = &target;
+}
+#endif
+
 //
 // R_FillBackScreen
 // Fills the back screen with a pattern
@@ -1069,10 +1108,16 @@ void R_FillBackScreen (void)
 
 void R_VideoErase(int x, int y, int count)
 {
+#ifdef COLUMN_MAJOR_SCREENS
+  // A row isn't contiguous
+  if (V_GetMode() != VID_MODEGL)
+    V_CopyRect(x, y, 1, count, 1, x, y, 0, VPT_NONE);
+#else
   if (V_GetMode() != VID_MODEGL)
     memcpy(screens[0].data+y*screens[0].byte_pitch+x*V_GetPixelDepth(),
            screens[1].data+y*screens[1].byte_pitch+x*V_GetPixelDepth(),
            count*V_GetPixelDepth());   // LFB copy.
+#endif
 }
 
 //
@@ -31,16 +31,34 @@
 
 #if (R_DRAWCOLUMN_PIPELINE_BITS == 8)
 #define SCREENTYPE byte
-#define TEMPBUF byte_tempbuf
+#define TOPLEFT byte_topleft
+#define PITCH byte_pitch
+#define TEMPBUF byte_tempbuf[renderthread]
 #elif (R_DRAWCOLUMN_PIPELINE_BITS == 15)
 #define SCREENTYPE unsigned short
-#define TEMPBUF short_tempbuf
+#define TOPLEFT short_topleft
+#define PITCH short_pitch
+#define TEMPBUF short_tempbuf[renderthread]
 #elif (R_DRAWCOLUMN_PIPELINE_BITS == 16)
 #define SCREENTYPE unsigned short
-#define TEMPBUF short_tempbuf
+#define TOPLEFT short_topleft
+#define PITCH short_pitch
+#define TEMPBUF short_tempbuf[renderthread]
 #elif (R_DRAWCOLUMN_PIPELINE_BITS == 32)
 #define SCREENTYPE unsigned int
-#define TEMPBUF int_tempbuf
+#define TOPLEFT int_topleft
+#define PITCH int_pitch
+#define TEMPBUF int_tempbuf[renderthread]
+#endif
+
+// With column major screens an opaque column is already contiguous in the
+// framebuffer, so it is drawn there directly instead of going through the
+// quad buffer. Translucent and fuzz columns still need the flush functions.
+#if defined(COLUMN_MAJOR_SCREENS) && !(R_DRAWCOLUMN_PIPELINE & (RDC_TRANSLUCENT|RDC_FUZZ))
+#define DIRECTCOLUMN
+#define DESTSTEP 1
+#else
+#define DESTSTEP 4
 #endif
 
 #define GETDESTCOLOR8(col) (col)
@@ -209,6 +227,12 @@ static void R_DRAWCOLUMN_FUNCNAME(draw_column_vars_t *dcvars)
   }
 
   // Framebuffer destination address.
+#ifdef DIRECTCOLUMN
+  // Anything still queued may be behind this column
+  if (temp_x)
+    R_FlushColumns();
+  dest = drawtarget->TOPLEFT + V_PIXOFS(dcvars->x, dcvars->yl, drawvars.PITCH);
+#else
    // SoM: MAGIC
    {
       // haleyjd: reordered predicates
@@ -244,6 +268,7 @@ static void R_DRAWCOLUMN_FUNCNAME(draw_column_vars_t *dcvars)
       }
       temp_x += 1;
    }
+#endif
 
 // do nothing else when drawin fuzz columns
 #if (!(R_DRAWCOLUMN_PIPELINE & RDC_FUZZ))
@@ -288,7 +313,7 @@ static void R_DRAWCOLUMN_FUNCNAME(draw_column_vars_t *dcvars)
       while(count--) {
         *dest = GETDESTCOLOR(GETCOL(frac & FIXEDT_128MASK, (frac+FRACUNIT) & FIXEDT_128MASK));
         INCY(y);
-        dest += 4;
+        dest += DESTSTEP;
         frac += fracstep;
       }
     } else if (dcvars->texheight == 0) {
@@ -296,7 +321,7 @@ static void R_DRAWCOLUMN_FUNCNAME(draw_column_vars_t *dcvars)
       while (count--) {
         *dest = GETDESTCOLOR(GETCOL(frac, (frac+FRACUNIT)));
         INCY(y);
-        dest += 4;
+        dest += DESTSTEP;
         frac += fracstep;
       }
     } else {
@@ -306,11 +331,11 @@ static void R_DRAWCOLUMN_FUNCNAME(draw_column_vars_t *dcvars)
         while ((count-=2)>=0) { // texture height is a power of 2 -- killough
           *dest = GETDESTCOLOR(GETCOL(frac & fixedt_heightmask, (frac+FRACUNIT) & fixedt_heightmask));
           INCY(y);
-          dest += 4;
+          dest += DESTSTEP;
           frac += fracstep;
           *dest = GETDESTCOLOR(GETCOL(frac & fixedt_heightmask, (frac+FRACUNIT) & fixedt_heightmask));
           INCY(y);
-          dest += 4;
+          dest += DESTSTEP;
           frac += fracstep;
         }
         if (count & 1)
@@ -344,7 +369,7 @@ static void R_DRAWCOLUMN_FUNCNAME(draw_column_vars_t *dcvars)
 
           *dest = GETDESTCOLOR(GETCOL(frac, nextfrac));
           INCY(y);
-          dest += 4;
+          dest += DESTSTEP;
           INCFRAC(frac);
 #if (R_DRAWCOLUMN_PIPELINE & (RDC_BILINEAR|RDC_ROUNDED))
           INCFRAC(nextfrac); 
@@ -371,7 +396,11 @@ static void R_DRAWCOLUMN_FUNCNAME(draw_column_vars_t *dcvars)
 #undef INCY
 #undef INCFRAC
 #undef COLTYPE
+#undef DESTSTEP
+#undef DIRECTCOLUMN
 #undef TEMPBUF
+#undef PITCH
+#undef TOPLEFT
 #undef SCREENTYPE
 
 #undef R_DRAWCOLUMN_FUNCNAME
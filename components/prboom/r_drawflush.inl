@@ -32,24 +32,28 @@
 #define SCREENTYPE byte
 #define TOPLEFT byte_topleft
 #define PITCH byte_pitch
-#define TEMPBUF byte_tempbuf
+#define TEMPBUF byte_tempbuf[renderthread]
 #elif (R_DRAWCOLUMN_PIPELINE_BITS == 15)
 #define SCREENTYPE unsigned short
 #define TOPLEFT short_topleft
 #define PITCH short_pitch
-#define TEMPBUF short_tempbuf
+#define TEMPBUF short_tempbuf[renderthread]
 #elif (R_DRAWCOLUMN_PIPELINE_BITS == 16)
 #define SCREENTYPE unsigned short
 #define TOPLEFT short_topleft
 #define PITCH short_pitch
-#define TEMPBUF short_tempbuf
+#define TEMPBUF short_tempbuf[renderthread]
 #elif (R_DRAWCOLUMN_PIPELINE_BITS == 32)
 #define SCREENTYPE unsigned int
 #define TOPLEFT int_topleft
 #define PITCH int_pitch
-#define TEMPBUF int_tempbuf
+#define TEMPBUF int_tempbuf[renderthread]
 #endif
 
+// Distance between neighbouring pixels of a row and of a column
+#define XSTEP V_XSTEP(drawvars.PITCH)
+#define YSTEP V_YSTEP(drawvars.PITCH)
+
 #if (R_DRAWCOLUMN_PIPELINE & RDC_TRANSLUCENT)
 #define GETDESTCOLOR8(col1, col2) (temptranmap[((col1)<<8)+(col2)])
 #define GETDESTCOLOR15(col1, col2) (GETBLENDED15_3268((col1), (col2)))
@@ -106,7 +110,7 @@ static void R_FLUSHWHOLE_FUNCNAME(void)
    {
       yl     = tempyl[temp_x];
       source = &TEMPBUF[temp_x + (yl << 2)];
-      dest   = drawvars.TOPLEFT + yl*drawvars.PITCH + startx + temp_x;
+      dest   = drawtarget->TOPLEFT + V_PIXOFS(startx + temp_x, yl, drawvars.PITCH);
       count  = tempyh[temp_x] - yl + 1;
       
       while(--count >= 0)
@@ -125,7 +129,7 @@ static void R_FLUSHWHOLE_FUNCNAME(void)
 #endif
 
          source += 4;
-         dest += drawvars.PITCH;
+         dest += YSTEP;
       }
    }
 }
@@ -153,7 +157,7 @@ static void R_FLUSHHEADTAIL_FUNCNAME(void)
       if(yl < commontop)
       {
          source = &TEMPBUF[colnum + (yl << 2)];
-         dest   = drawvars.TOPLEFT + yl*drawvars.PITCH + startx + colnum;
+         dest   = drawtarget->TOPLEFT + V_PIXOFS(startx + colnum, yl, drawvars.PITCH);
          count  = commontop - yl;
          
          while(--count >= 0)
@@ -173,7 +177,7 @@ static void R_FLUSHHEADTAIL_FUNCNAME(void)
 #endif
 
             source += 4;
-            dest += drawvars.PITCH;
+            dest += YSTEP;
          }
       }
       
@@ -181,7 +185,7 @@ static void R_FLUSHHEADTAIL_FUNCNAME(void)
       if(yh > commonbot)
       {
          source = &TEMPBUF[colnum + ((commonbot + 1) << 2)];
-         dest   = drawvars.TOPLEFT + (commonbot + 1)*drawvars.PITCH + startx + colnum;
+         dest   = drawtarget->TOPLEFT + V_PIXOFS(startx + colnum, commonbot + 1, drawvars.PITCH);
          count  = yh - commonbot;
          
          while(--count >= 0)
@@ -201,7 +205,7 @@ static void R_FLUSHHEADTAIL_FUNCNAME(void)
 #endif
 
             source += 4;
-            dest += drawvars.PITCH;
+            dest += YSTEP;
          }
       }         
       ++colnum;
@@ -211,7 +215,7 @@ static void R_FLUSHHEADTAIL_FUNCNAME(void)
 static void R_FLUSHQUAD_FUNCNAME(void)
 {
    SCREENTYPE *source = &TEMPBUF[commontop << 2];
-   SCREENTYPE *dest = drawvars.TOPLEFT + commontop*drawvars.PITCH + startx;
+   SCREENTYPE *dest = drawtarget->TOPLEFT + V_PIXOFS(startx, commontop, drawvars.PITCH);
    int count;
 #if (R_DRAWCOLUMN_PIPELINE & RDC_FUZZ)
    int fuzz1, fuzz2, fuzz3, fuzz4;
@@ -228,55 +232,55 @@ static void R_FLUSHQUAD_FUNCNAME(void)
    while(--count >= 0)
    {
       dest[0] = GETDESTCOLOR(dest[0], source[0]);
-      dest[1] = GETDESTCOLOR(dest[1], source[1]);
-      dest[2] = GETDESTCOLOR(dest[2], source[2]);
-      dest[3] = GETDESTCOLOR(dest[3], source[3]);
+      dest[XSTEP] = GETDESTCOLOR(dest[XSTEP], source[1]);
+      dest[2*XSTEP] = GETDESTCOLOR(dest[2*XSTEP], source[2]);
+      dest[3*XSTEP] = GETDESTCOLOR(dest[3*XSTEP], source[3]);
       source += 4 * sizeof(byte);
-      dest += drawvars.PITCH * sizeof(byte);
+      dest += YSTEP;
    }
 #elif (R_DRAWCOLUMN_PIPELINE & RDC_FUZZ)
    while(--count >= 0)
    {
       dest[0] = GETDESTCOLOR(dest[0 + fuzzoffset[fuzz1]]);
-      dest[1] = GETDESTCOLOR(dest[1 + fuzzoffset[fuzz2]]);
-      dest[2] = GETDESTCOLOR(dest[2 + fuzzoffset[fuzz3]]);
-      dest[3] = GETDESTCOLOR(dest[3 + fuzzoffset[fuzz4]]);
+      dest[XSTEP] = GETDESTCOLOR(dest[XSTEP + fuzzoffset[fuzz2]]);
+      dest[2*XSTEP] = GETDESTCOLOR(dest[2*XSTEP + fuzzoffset[fuzz3]]);
+      dest[3*XSTEP] = GETDESTCOLOR(dest[3*XSTEP + fuzzoffset[fuzz4]]);
       fuzz1 = (fuzz1 + 1) % FUZZTABLE;
       fuzz2 = (fuzz2 + 1) % FUZZTABLE;
       fuzz3 = (fuzz3 + 1) % FUZZTABLE;
       fuzz4 = (fuzz4 + 1) % FUZZTABLE;
       source += 4 * sizeof(byte);
-      dest += drawvars.PITCH * sizeof(byte);
+      dest += YSTEP;
    }
 #else
-  #if (R_DRAWCOLUMN_PIPELINE_BITS == 8)
+  #if (R_DRAWCOLUMN_PIPELINE_BITS == 8) && !defined(COLUMN_MAJOR_SCREENS)
    if ((sizeof(int) == 4) && (((int)source % 4) == 0) && (((int)dest % 4) == 0)) {
       while(--count >= 0)
       {
          *(int *)dest = *(int *)source;
          source += 4 * sizeof(byte);
-         dest += drawvars.PITCH * sizeof(byte);
+         dest += YSTEP;
       }
    } else {
       while(--count >= 0)
       {
          dest[0] = source[0];
-         dest[1] = source[1];
-         dest[2] = source[2];
-         dest[3] = source[3];
+         dest[XSTEP] = source[1];
+         dest[2*XSTEP] = source[2];
+         dest[3*XSTEP] = source[3];
          source += 4 * sizeof(byte);
-         dest += drawvars.PITCH * sizeof(byte);
+         dest += YSTEP;
       }
    }
   #else
    while(--count >= 0)
    {
       dest[0] = source[0];
-      dest[1] = source[1];
-      dest[2] = source[2];
-      dest[3] = source[3];
+      dest[XSTEP] = source[1];
+      dest[2*XSTEP] = source[2];
+      dest[3*XSTEP] = source[3];
       source += 4;
-      dest += drawvars.PITCH;
+      dest += YSTEP;
    }
   #endif
 #endif
@@ -288,6 +292,8 @@ static void R_FLUSHQUAD_FUNCNAME(void)
 #undef GETDESTCOLOR8
 #undef GETDESTCOLOR
 
+#undef XSTEP
+#undef YSTEP
 #undef TEMPBUF
 #undef PITCH
 #undef TOPLEFT
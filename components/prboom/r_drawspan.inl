@@ -97,7 +97,8 @@ static void R_DRAWSPAN_FUNCNAME(draw_span_vars_t *dsvars)
   const fixed_t ystep = dsvars->ystep;
   const byte *source = dsvars->source;
   const byte *colormap = dsvars->colormap;
-  SCREENTYPE *dest = drawvars.TOPLEFT + dsvars->y*drawvars.PITCH + dsvars->x1;
+  SCREENTYPE *dest = drawtarget->TOPLEFT + V_PIXOFS(dsvars->x1, dsvars->y, drawvars.PITCH);
+  const int deststep = V_XSTEP(drawvars.PITCH);
 #if (R_DRAWSPAN_PIPELINE & (RDC_DITHERZ|RDC_BILINEAR))
   const int y = dsvars->y;
   int x1 = dsvars->x1;
@@ -110,7 +111,8 @@ static void R_DRAWSPAN_FUNCNAME(draw_span_vars_t *dsvars)
   while (count) {
 #if ((R_DRAWSPAN_PIPELINE_BITS != 8) && (R_DRAWSPAN_PIPELINE & RDC_BILINEAR))
     // truecolor bilinear filtered
-    *dest++ = GETCOL(0);
+    *dest = GETCOL(0);
+    dest += deststep;
     xfrac += xstep;
     yfrac += ystep;
     count--;
@@ -118,7 +120,8 @@ static void R_DRAWSPAN_FUNCNAME(draw_span_vars_t *dsvars)
     x1--;
   #endif
 #elif (R_DRAWSPAN_PIPELINE & RDC_ROUNDED)
-    *dest++ = GETCOL(filter_getRoundedForSpan(xfrac, yfrac));
+    *dest = GETCOL(filter_getRoundedForSpan(xfrac, yfrac));
+    dest += deststep;
     xfrac += xstep;
     yfrac += ystep;
     count--;
@@ -137,7 +140,8 @@ static void R_DRAWSPAN_FUNCNAME(draw_span_vars_t *dsvars)
     const fixed_t spot = xtemp | ytemp;
     xfrac += xstep;
     yfrac += ystep;
-    *dest++ = GETCOL(source[spot]);
+    *dest = GETCOL(source[spot]);
+    dest += deststep;
     count--;
   #if (R_DRAWSPAN_PIPELINE & (RDC_DITHERZ|RDC_BILINEAR))
     x1--;
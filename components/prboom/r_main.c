@@ -55,6 +55,7 @@
 #include "st_stuff.h"
 #include "i_main.h"
 #include "i_system.h"
+#include "i_video.h"
 #include "g_game.h"
 #include "r_demo.h"
 #include "r_fps.h"
@@ -68,17 +69,22 @@
 
 int viewangleoffset;
 int validcount = 1;         // increment every time a check is made
-const lighttable_t *fixedcolormap;
+int render_strips;          // render the view in this many horizontal strips
+R_LOCAL int viewstartx, viewstopx; // columns drawn by this render thread
+#if defined SPLIT_RENDER || defined PIPELINE_RENDER
+R_LOCAL int renderthread;
+#endif
+R_LOCAL const lighttable_t *fixedcolormap;
 int      centerx, centery;
 fixed_t  centerxfrac, centeryfrac;
 fixed_t  viewheightfrac; //e6y: for correct clipping of things
 fixed_t  projection;
 // proff 11/06/98: Added for high-res
 fixed_t  projectiony;
-fixed_t  viewx, viewy, viewz;
-angle_t  viewangle;
-fixed_t  viewcos, viewsin;
-player_t *viewplayer;
+R_LOCAL fixed_t  viewx, viewy, viewz;
+R_LOCAL angle_t  viewangle;
+R_LOCAL fixed_t  viewcos, viewsin;
+R_LOCAL player_t *viewplayer;
 extern lighttable_t **walllights;
 
 static mobj_t *oviewer;
@@ -107,13 +113,13 @@ angle_t xtoviewangle[MAX_SCREENWIDTH+1];   // killough 2/8/98
 
 int numcolormaps;
 const lighttable_t *(*c_zlight)[LIGHTLEVELS][MAXLIGHTZ];
-const lighttable_t *(*zlight)[MAXLIGHTZ];
-const lighttable_t *fullcolormap;
+R_LOCAL const lighttable_t *(*zlight)[MAXLIGHTZ];
+R_LOCAL const lighttable_t *fullcolormap;
 const lighttable_t **colormaps;
 
 // killough 3/20/98, 4/4/98: end dynamic colormaps
 
-int extralight;                           // bumped light from gun blasts
+R_LOCAL int extralight;                   // bumped light from gun blasts
 
 //
 // R_PointOnSide
@@ -182,8 +188,8 @@ PUREFUNC int R_PointOnSegSide(fixed_t x, fixed_t y, const seg_t *line)
 
 angle_t R_PointToAngle(fixed_t x, fixed_t y)
 {
-  static fixed_t oldx, oldy;
-  static angle_t oldresult;
+  static R_LOCAL fixed_t oldx, oldy;
+  static R_LOCAL angle_t oldresult;
 
   x -= viewx; y -= viewy;
 
@@ -364,6 +370,7 @@ void R_ExecuteSetViewSize (void)
 {
   int i;
 
+  R_DropPipelinedFrame ();
   setsizeneeded = false;
 
   if (setblocks == 11)
@@ -532,8 +539,10 @@ int autodetect_hom = 0;       // killough 2/7/98: HOM autodetection flag
 //
 // R_ShowStats
 //
-int rendered_visplanes, rendered_segs, rendered_vissprites;
-boolean rendering_stats=1;
+R_LOCAL int rendered_visplanes, rendered_segs, rendered_vissprites, rendered_nodes;
+R_LOCAL int rendered_walltime, rendered_flattime, rendered_spritetime;
+int rendered_2dtime;
+boolean rendering_stats=0;
 
 static void R_ShowStats(void)
 {
@@ -561,9 +570,11 @@ static void R_ShowStats(void)
   if (now - showtime > 35) {
     doom_printf((V_GetMode() == VID_MODEGL)
                 ?"Frame rate %d fps\nWalls %d, Flats %d, Sprites %d"
-                :"Frame rate %d fps\nSegs %d, Visplanes %d, Sprites %d",
+                :"Frame rate %d fps\nSegs %d, Visplanes %d, Sprites %d, Nodes %d\n"
+                 "us: walls %d, flats %d, sprites %d, 2d %d",
     (35*KEEPTIMES)/(now - keeptime[0]), rendered_segs,
-    rendered_visplanes, rendered_vissprites);
+    rendered_visplanes, rendered_vissprites, rendered_nodes,
+    rendered_walltime, rendered_flattime, rendered_spritetime, rendered_2dtime);
     showtime = now;
   }
   memmove(keeptime, keeptime+1, sizeof(keeptime[0]) * (KEEPTIMES-1));
@@ -575,9 +586,33 @@ static void R_ShowStats(void)
 //
 // R_RenderView
 //
-void R_RenderPlayerView (player_t* player)
+//
+// R_SetViewStrip
+// Limits drawing to view rows top..bottom-1. negonearray/screenheightarray
+// are the default clip for everything drawn, so they carry the limits.
+//
+
+static void R_SetViewStrip(int top, int bottom)
 {
-  R_SetupFrame (player);
+  int i;
+
+  for (i=0 ; i<viewwidth ; i++)
+    {
+      negonearray[i] = top-1;
+      screenheightarray[i] = bottom;
+    }
+}
+
+//
+// R_RenderWalls
+// The BSP walk, which draws the walls and collects the visplanes,
+// drawsegs and vissprites that R_RenderPlanesAndMasked draws from.
+// That doesn't look at the level's things or the player any more.
+//
+
+static void R_RenderWalls(void)
+{
+  unsigned long t = I_GetTimeUS();
 
   // Clear buffers.
   R_ClearClipSegs ();
@@ -585,7 +620,325 @@ void R_RenderPlayerView (player_t* player)
   R_ClearPlanes ();
   R_ClearSprites ();
 
-  rendered_segs = rendered_visplanes = 0;
+  // The head node is the last node output.
+  R_RenderBSPNode (numnodes-1);
+  R_ResetColumnBuffer();
+  if (V_GetMode() != VID_MODEGL)
+    R_ProjectPlayerSprites ();
+  rendered_walltime += I_GetTimeUS() - t;
+}
+
+static void R_RenderPlanesAndMasked(void)
+{
+  unsigned long t = I_GetTimeUS();
+
+  if (V_GetMode() != VID_MODEGL)
+    R_DrawPlanes ();
+  rendered_flattime += I_GetTimeUS() - t;
+  t = I_GetTimeUS();
+
+  // Check for new console commands.
+#ifdef HAVE_NET
+  NetUpdate ();
+#endif
+
+  if (V_GetMode() != VID_MODEGL) {
+    R_DrawMasked ();
+    R_ResetColumnBuffer();
+  }
+  rendered_spritetime += I_GetTimeUS() - t;
+}
+
+static void R_RenderView(void)
+{
+  R_RenderWalls ();
+
+  // Check for new console commands.
+#ifdef HAVE_NET
+  NetUpdate ();
+#endif
+
+  R_RenderPlanesAndMasked ();
+}
+
+#if defined SPLIT_RENDER || defined PIPELINE_RENDER
+//
+// The point of view set up by R_SetupFrame, which the other render
+// thread needs a copy of.
+//
+
+typedef struct {
+  fixed_t x, y, z;
+  angle_t angle;
+  fixed_t cos, sin;
+  player_t *player;
+  int extralight;
+  const lighttable_t *fixedcolormap, *fullcolormap;
+  const lighttable_t *(*zlight)[MAXLIGHTZ];
+} renderview_t;
+
+static void R_SaveView(renderview_t *v)
+{
+  v->x = viewx;
+  v->y = viewy;
+  v->z = viewz;
+  v->angle = viewangle;
+  v->cos = viewcos;
+  v->sin = viewsin;
+  v->player = viewplayer;
+  v->extralight = extralight;
+  v->fixedcolormap = fixedcolormap;
+  v->fullcolormap = fullcolormap;
+  v->zlight = zlight;
+}
+
+static void R_LoadView(const renderview_t *v)
+{
+  viewx = v->x;
+  viewy = v->y;
+  viewz = v->z;
+  viewangle = v->angle;
+  viewcos = v->cos;
+  viewsin = v->sin;
+  viewplayer = v->player;
+  extralight = v->extralight;
+  fixedcolormap = v->fixedcolormap;
+  fullcolormap = v->fullcolormap;
+  zlight = v->zlight;
+}
+#endif
+
+#ifdef SPLIT_RENDER
+//
+// R_RenderSplitView
+// The view is cut at column splitx. The left part is drawn here, the
+// right part by a worker thread on the other core, each with its own
+// renderer state, so the two only meet at the start and end of the
+// frame. The cut moves towards whichever side took longer. Walls and
+// flats are stepped from the seg's first column and the view's left edge
+// (R_StoreWallRange, R_MapPlane), so a column comes out the same on
+// either side of the cut.
+//
+
+static int splitx;
+static int splittime[RENDER_THREADS];
+static renderview_t splitview;
+
+static void R_RenderRightView(void)
+{
+  unsigned long t = I_GetTimeUS();
+
+  R_LoadView (&splitview);
+  renderthread = 1;
+  viewstartx = splitx;
+  viewstopx = viewwidth;
+  rendered_segs = rendered_visplanes = rendered_nodes = 0;
+  rendered_walltime = rendered_flattime = rendered_spritetime = 0;
+  R_RenderView ();
+  splittime[1] = I_GetTimeUS() - t;
+}
+
+static void R_RenderSplitView(void)
+{
+  static boolean started;
+  unsigned long t;
+  int minx = (viewwidth/4) & ~3, maxx = (viewwidth*3/4) & ~3;
+
+  if (!started)
+    {
+      I_StartRenderThread(R_RenderRightView);
+      started = true;
+    }
+
+  // On a multiple of 4, so the threads never share a 32 bit screen word
+  if (splitx < minx || splitx > maxx)
+    splitx = (viewwidth/2) & ~3;
+
+  R_SaveView (&splitview);
+  I_SignalRenderThread();
+  t = I_GetTimeUS();
+  viewstopx = splitx;
+  R_RenderView ();
+  splittime[0] = I_GetTimeUS() - t;
+  I_WaitRenderThread();
+
+  if (splittime[0] > splittime[1] + splittime[1]/8 && splitx > minx)
+    splitx -= 4;
+  else if (splittime[1] > splittime[0] + splittime[0]/8 && splitx < maxx)
+    splitx += 4;
+}
+#endif
+
+#ifdef PIPELINE_RENDER
+//
+// R_RenderPipelinedView
+// The walls of a frame are drawn on the game's core. Its flats, sprites
+// and psprites are then drawn by a worker on the other core, into a
+// framebuffer held back from the video code (I_HoldFrame), while the game
+// goes on with the next tics and the next frame's walls. The second half
+// only draws from what the first half collected, so the game can change
+// the level under it: what it needs of sector heights, light levels,
+// sidedefs and the animation tables is copied into the drawsegs, visplanes
+// and vissprites as they are stored. Its drawsegs still point into the
+// level for its static geometry, which is why P_SetupLevel has to drop it.
+// Each frame in flight keeps its own visplanes, drawsegs, openings and
+// vissprites until its second half is done, picked by renderthread.
+//
+
+typedef struct {
+  renderview_t view;
+  byte *screen;                 // framebuffer the walls went into
+  drawseg_t *drawsegs, *ds_p;
+  unsigned maxdrawsegs;
+  int *openings;                // dropoff overflow
+  size_t maxopenings;
+  vissprite_t *vissprites;
+  size_t num_vissprite, num_vissprite_alloc;
+  int visplanes, sprites, flattime, spritetime; // stats of the second half
+} renderframe_t;
+
+static renderframe_t pipeframes[RENDER_THREADS];
+static int pipeframe;           // frame in the worker's hands, 0 for none
+
+static void R_UseFrameBuffers(const renderframe_t *f)
+{
+  drawsegs = f->drawsegs;
+  ds_p = f->ds_p;
+  maxdrawsegs = f->maxdrawsegs;
+  openings = f->openings;
+  maxopenings = f->maxopenings;
+  vissprites = f->vissprites;
+  num_vissprite = f->num_vissprite;
+  num_vissprite_alloc = f->num_vissprite_alloc;
+}
+
+static void R_KeepFrameBuffers(renderframe_t *f)
+{
+  f->drawsegs = drawsegs;
+  f->ds_p = ds_p;
+  f->maxdrawsegs = maxdrawsegs;
+  f->openings = openings;
+  f->maxopenings = maxopenings;
+  f->vissprites = vissprites;
+  f->num_vissprite = num_vissprite;
+  f->num_vissprite_alloc = num_vissprite_alloc;
+}
+
+static void R_FinishPipelinedFrame(void)
+{
+  renderframe_t *f = &pipeframes[pipeframe];
+
+  renderthread = pipeframe;
+  viewstartx = 0;
+  viewstopx = viewwidth;
+  R_LoadView (&f->view);
+  R_UseFrameBuffers (f);
+  R_SetViewTarget (f->screen);
+  rendered_visplanes = rendered_vissprites = 0;
+  rendered_flattime = rendered_spritetime = 0;
+  R_RenderPlanesAndMasked ();
+  f->visplanes = rendered_visplanes;
+  f->sprites = rendered_vissprites;
+  f->flattime = rendered_flattime;
+  f->spritetime = rendered_spritetime;
+}
+
+static void R_RenderPipelinedView(void)
+{
+  static boolean started;
+  int frame = pipeframe == 1 ? 2 : 1;
+  renderframe_t *f = &pipeframes[frame], own;
+
+  if (!started)
+    {
+      I_StartRenderThread(R_FinishPipelinedFrame);
+      started = true;
+    }
+
+  // The game's own buffers are left alone
+  R_KeepFrameBuffers (&own);
+  renderthread = frame;
+  R_UseFrameBuffers (f);
+
+  if (pipeframe)
+    {
+      // This frame's walls go into screens[0], which then trades places
+      // with the last frame once the worker is done with it
+      f->screen = screens[0].data;
+      R_RenderWalls ();
+      I_WaitRenderThread();
+      screens[0].data = pipeframes[pipeframe].screen;
+      R_RebaseBuffer();
+      rendered_visplanes = pipeframes[pipeframe].visplanes;
+      rendered_vissprites = pipeframes[pipeframe].sprites;
+      rendered_flattime = pipeframes[pipeframe].flattime;
+      rendered_spritetime = pipeframes[pipeframe].spritetime;
+    }
+  else
+    {
+      // Nothing is on its way: draw this frame whole, and once more into
+      // another framebuffer to get the pipeline going
+      renderthread = 0;
+      R_UseFrameBuffers (&own);
+      R_RenderView ();
+      R_KeepFrameBuffers (&own);
+      renderthread = frame;
+      R_UseFrameBuffers (f);
+      f->screen = I_GetFreeFrame();
+      R_SetViewTarget (f->screen);
+      R_RenderWalls ();
+      R_SetViewTarget (NULL);
+    }
+
+  R_KeepFrameBuffers (f);
+  R_SaveView (&f->view);
+  I_HoldFrame (f->screen);
+  pipeframe = frame;
+  I_SignalRenderThread();
+
+  renderthread = 0;
+  R_UseFrameBuffers (&own);
+}
+#endif
+
+//
+// R_DropPipelinedFrame
+// Waits for the frame R_RenderPipelinedView left to the worker and forgets
+// it, when screens[0] won't take its place or the level it shows is gone.
+//
+
+void R_DropPipelinedFrame(void)
+{
+#ifdef PIPELINE_RENDER
+  if (pipeframe)
+    {
+      I_WaitRenderThread();
+      I_HoldFrame(NULL);
+      pipeframe = 0;
+    }
+#endif
+}
+
+void R_RenderPlayerView (player_t* player)
+{
+  int strip, strips = 1;
+
+  R_SetupFrame (player);
+
+  // With render_strips the view is drawn in horizontal strips, each
+  // handed to the video code as soon as it is done, so the display can
+  // send one while the next is drawn. This is slower than drawing the view
+  // whole: the BSP is walked again for every strip (each walk only stops
+  // early once its strip's columns are closed, see the Nodes stat), and
+  // it draws into the full screens[0], so it saves no memory unless the
+  // video code keeps its framebuffers out of internal RAM. Off by default.
+  if (render_strips > 1 && V_GetMode() != VID_MODEGL)
+    strips = render_strips < viewheight ? render_strips : viewheight;
+
+  rendered_segs = rendered_visplanes = rendered_nodes = 0;
+  rendered_walltime = rendered_flattime = rendered_spritetime = 0;
+  viewstartx = 0;
+  viewstopx = viewwidth;
   if (V_GetMode() == VID_MODEGL)
   {
 #ifdef GL_DOOM
@@ -608,27 +961,30 @@ void R_RenderPlayerView (player_t* player)
   NetUpdate ();
 #endif
 
-  // The head node is the last node output.
-  R_RenderBSPNode (numnodes-1);
-  R_ResetColumnBuffer();
+  if (strips > 1)
+    {
+      for (strip=0 ; strip<strips ; strip++)
+        {
+          int top = viewheight*strip/strips;
+          int bottom = viewheight*(strip+1)/strips;
 
-  // Check for new console commands.
-#ifdef HAVE_NET
-  NetUpdate ();
+          R_SetViewStrip (top, bottom);
+          validcount++; // so R_AddSprites picks up every sector again
+          R_RenderView ();
+          I_FinishViewStrip (viewwindowy+top, viewwindowy+bottom, strip == strips-1);
+        }
+      R_SetViewStrip (0, viewheight);
+    }
+#ifdef SPLIT_RENDER
+  else if (V_GetMode() != VID_MODEGL)
+    R_RenderSplitView ();
 #endif
-
-  if (V_GetMode() != VID_MODEGL)
-    R_DrawPlanes ();
-
-  // Check for new console commands.
-#ifdef HAVE_NET
-  NetUpdate ();
+#ifdef PIPELINE_RENDER
+  else if (V_GetMode() != VID_MODEGL && !autodetect_hom && use_doublebuffer)
+    R_RenderPipelinedView ();
 #endif
-
-  if (V_GetMode() != VID_MODEGL) {
-    R_DrawMasked ();
-    R_ResetColumnBuffer();
-  }
+  else
+    R_RenderView ();
 
   // Check for new console commands.
 #ifdef HAVE_NET
@@ -644,7 +1000,7 @@ void R_RenderPlayerView (player_t* player)
 #endif
   }
 
-  if (rendering_stats) R_ShowStats();
+  if (rendering_stats && !zone_stats) R_ShowStats();
 
   R_RestoreInterpolations();
 }
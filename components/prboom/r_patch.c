@@ -678,6 +678,8 @@ const rpatch_t *R_CachePatchNum(int id) {
     I_Error("createPatch: %i >= numlumps", id);
 #endif
 
+  I_LockRenderCache();
+
   if (!patches[id].data)
     createPatch(id);
 
@@ -696,12 +698,15 @@ const rpatch_t *R_CachePatchNum(int id) {
 	    lumpinfo[id].name, patches[id].locks);
 #endif
 
+  I_UnlockRenderCache();
   return &patches[id];
 }
 
 void R_UnlockPatchNum(int id)
 {
   const int unlocks = 1;
+
+  I_LockRenderCache();
 #ifdef SIMPLECHECKS
   if ((signed short)patches[id].locks < unlocks)
     lprintf(LO_DEBUG, "R_UnlockPatchNum: Excess unlocks on %8s (%d-%d)\n", 
@@ -713,6 +718,7 @@ void R_UnlockPatchNum(int id)
    */
   if (unlocks && !patches[id].locks)
     Z_ChangeTag(patches[id].data, PU_CACHE);
+  I_UnlockRenderCache();
 }
 
 //---------------------------------------------------------------------------
@@ -727,6 +733,8 @@ const rpatch_t *R_CacheTextureCompositePatchNum(int id) {
     I_Error("createTextureCompositePatch: %i >= numtextures", id);
 #endif
 
+  I_LockRenderCache();
+
   if (!texture_composites[id].data)
     createTextureCompositePatch(id);
 
@@ -745,6 +753,7 @@ const rpatch_t *R_CacheTextureCompositePatchNum(int id) {
 	    textures[id]->name, texture_composites[id].locks);
 #endif
 
+  I_UnlockRenderCache();
   return &texture_composites[id];
 
 }
@@ -752,6 +761,8 @@ const rpatch_t *R_CacheTextureCompositePatchNum(int id) {
 void R_UnlockTextureCompositePatchNum(int id)
 {
   const int unlocks = 1;
+
+  I_LockRenderCache();
 #ifdef SIMPLECHECKS
   if ((signed short)texture_composites[id].locks < unlocks)
     lprintf(LO_DEBUG, "R_UnlockTextureCompositePatchNum: Excess unlocks on %8s (%d-%d)\n", 
@@ -763,6 +774,7 @@ void R_UnlockTextureCompositePatchNum(int id)
    */
   if (unlocks && !texture_composites[id].locks)
     Z_ChangeTag(texture_composites[id].data, PU_CACHE);
+  I_UnlockRenderCache();
 }
 
 //---------------------------------------------------------------------------
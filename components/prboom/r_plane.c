@@ -64,10 +64,10 @@
 
 #define MAXVISPLANES 128    /* must be a power of 2 */
 
-static visplane_t *visplanes[MAXVISPLANES];   // killough
-static visplane_t *freetail;                  // killough
-static visplane_t **freehead = &freetail;     // killough
-visplane_t *floorplane, *ceilingplane;
+static visplane_t *visplanes[RENDER_THREADS][MAXVISPLANES]; // killough
+static R_LOCAL visplane_t *freetail;                  // killough
+static R_LOCAL visplane_t **freehead;                 // killough
+R_LOCAL visplane_t *floorplane, *ceilingplane;
 
 // killough -- hash function for visplanes
 // Empirically verified to be fairly uniform:
@@ -75,8 +75,8 @@ visplane_t *floorplane, *ceilingplane;
 #define visplane_hash(picnum,lightlevel,height) \
   ((unsigned)((picnum)*3+(lightlevel)+(height)*7) & (MAXVISPLANES-1))
 
-size_t maxopenings;
-int *openings,*lastopening; // dropoff overflow
+R_LOCAL size_t maxopenings;
+R_LOCAL int *openings,*lastopening; // dropoff overflow
 
 // Clip values are the solid pixel bounding the range.
 //  floorclip starts out SCREENHEIGHT
@@ -86,23 +86,23 @@ int floorclip[MAX_SCREENWIDTH], ceilingclip[MAX_SCREENWIDTH]; // dropoff overflo
 
 // spanstart holds the start of a plane span; initialized to 0 at start
 
-static int spanstart[MAX_SCREENHEIGHT];                // killough 2/8/98
+static int spanstart[RENDER_THREADS][MAX_SCREENHEIGHT]; // killough 2/8/98
 
 //
 // texture mapping
 //
 
-static const lighttable_t **planezlight;
-static fixed_t planeheight;
+static R_LOCAL const lighttable_t **planezlight;
+static R_LOCAL fixed_t planeheight;
 
 // killough 2/8/98: make variables static
 
-static fixed_t basexscale, baseyscale;
-static fixed_t cachedheight[MAX_SCREENHEIGHT];
-static fixed_t cacheddistance[MAX_SCREENHEIGHT];
-static fixed_t cachedxstep[MAX_SCREENHEIGHT];
-static fixed_t cachedystep[MAX_SCREENHEIGHT];
-static fixed_t xoffs,yoffs;    // killough 2/28/98: flat offsets
+static R_LOCAL fixed_t basexscale, baseyscale;
+static fixed_t cachedheight[RENDER_THREADS][MAX_SCREENHEIGHT];
+static fixed_t cacheddistance[RENDER_THREADS][MAX_SCREENHEIGHT];
+static fixed_t cachedxstep[RENDER_THREADS][MAX_SCREENHEIGHT];
+static fixed_t cachedystep[RENDER_THREADS][MAX_SCREENHEIGHT];
+static R_LOCAL fixed_t xoffs,yoffs;    // killough 2/28/98: flat offsets
 
 fixed_t yslope[MAX_SCREENHEIGHT], distscale[MAX_SCREENWIDTH];
 
@@ -141,26 +141,40 @@ static void IRAM_ATTR R_MapPlane(int y, int x1, int x2, draw_span_vars_t *dsvars
     I_Error ("R_MapPlane: %i, %i at %i",x1,x2,y);
 #endif
 
-  if (planeheight != cachedheight[y])
+  if (planeheight != cachedheight[renderthread][y])
     {
-      cachedheight[y] = planeheight;
-      distance = cacheddistance[y] = FixedMul (planeheight, yslope[y]);
-      dsvars->xstep = cachedxstep[y] = FixedMul (distance,basexscale);
-      dsvars->ystep = cachedystep[y] = FixedMul (distance,baseyscale);
+      cachedheight[renderthread][y] = planeheight;
+      distance = cacheddistance[renderthread][y] = FixedMul (planeheight, yslope[y]);
+      dsvars->xstep = cachedxstep[renderthread][y] = FixedMul (distance,basexscale);
+      dsvars->ystep = cachedystep[renderthread][y] = FixedMul (distance,baseyscale);
     }
   else
     {
-      distance = cacheddistance[y];
-      dsvars->xstep = cachedxstep[y];
-      dsvars->ystep = cachedystep[y];
+      distance = cacheddistance[renderthread][y];
+      dsvars->xstep = cachedxstep[renderthread][y];
+      dsvars->ystep = cachedystep[renderthread][y];
     }
 
+#ifdef SPLIT_RENDER
+  // Stepped from the left edge of the view rather than worked out at x1,
+  // so a column comes out the same on either side of the cut between the
+  // render threads, wherever the cut is this frame.
+  length = FixedMul (distance,distscale[0]);
+  angle = (viewangle + xtoviewangle[0])>>ANGLETOFINESHIFT;
+
+  // killough 2/28/98: Add offsets
+  dsvars->xfrac =  viewx + FixedMul(finecosine[angle], length) + xoffs
+    + x1*dsvars->xstep;
+  dsvars->yfrac = -viewy - FixedMul(finesine[angle],   length) + yoffs
+    + x1*dsvars->ystep;
+#else
   length = FixedMul (distance,distscale[x1]);
   angle = (viewangle + xtoviewangle[x1])>>ANGLETOFINESHIFT;
 
   // killough 2/28/98: Add offsets
   dsvars->xfrac =  viewx + FixedMul(finecosine[angle], length) + xoffs;
   dsvars->yfrac = -viewy - FixedMul(finesine[angle],   length) + yoffs;
+#endif
 
   if (drawvars.filterfloor == RDRAW_FILTER_LINEAR) {
     dsvars->xfrac -= (FRACUNIT>>1);
@@ -199,21 +213,18 @@ void R_ClearPlanes(void)
   int i;
 
   // opening / clipping determination
-  for (i=0 ; i<viewwidth ; i++)
-    floorclip[i] = viewheight, ceilingclip[i] = -1;
+  // (screenheightarray/negonearray, as they may be limited to a strip)
+  for (i=viewstartx ; i<viewstopx ; i++)
+    floorclip[i] = screenheightarray[i], ceilingclip[i] = negonearray[i];
+
+  if (!freehead)                  // first frame on this render thread
+    freehead = &freetail;
 
   for (i=0;i<MAXVISPLANES;i++)    // new code -- killough
-    for (*freehead = visplanes[i], visplanes[i] = NULL; *freehead; )
+    for (*freehead = visplanes[renderthread][i], visplanes[renderthread][i] = NULL; *freehead; )
       freehead = &(*freehead)->next;
 
   lastopening = openings;
-
-  // texture calculation
-  memset (cachedheight, 0, sizeof(cachedheight));
-
-  // scale will be unit scale at SCREENWIDTH/2 distance
-  basexscale = FixedDiv (viewsin,projection);
-  baseyscale = FixedDiv (viewcos,projection);
 }
 
 // New function, by Lee Killough
@@ -226,8 +237,8 @@ static visplane_t *new_visplane(unsigned hash)
   else
     if (!(freetail = freetail->next))
       freehead = &freetail;
-  check->next = visplanes[hash];
-  visplanes[hash] = check;
+  check->next = visplanes[renderthread][hash];
+  visplanes[renderthread][hash] = check;
   return check;
 }
 
@@ -246,11 +257,72 @@ visplane_t *R_DupPlane(const visplane_t *pl, int start, int stop)
       new_pl->lightlevel = pl->lightlevel;
       new_pl->xoffs = pl->xoffs;           // killough 2/28/98
       new_pl->yoffs = pl->yoffs;
+      new_pl->source = pl->source;
+      new_pl->skyangle = pl->skyangle;
+      new_pl->skymid = pl->skymid;
+      new_pl->skyflip = pl->skyflip;
       new_pl->minx = start;
       new_pl->maxx = stop;
       memset(new_pl->top, 0xff, sizeof new_pl->top);
       return new_pl;
 }
+//
+// R_SetPlaneSource
+//
+// Work out what the plane draws from the animation tables and, for a sky
+// transferred from a sidedef, the linedef and sidedef, moved here from
+// R_DoDrawPlane. The game may have run on by the time it is drawn
+// (PIPELINE_RENDER).
+//
+
+static void R_SetPlaneSource(visplane_t *pl)
+{
+  if (pl->picnum & PL_SKYFLAT)
+  {
+    // killough 10/98: allow skies to come from sidedefs.
+    // Allows scrolling and/or animated skies, as well as
+    // arbitrary multiple skies per level without having
+    // to use info lumps.
+
+    // Sky Linedef
+    const line_t *l = &lines[pl->picnum & ~PL_SKYFLAT];
+
+    // Sky transferred from first sidedef
+    const side_t *s = *l->sidenum + sides;
+
+    // Texture comes from upper texture of reference sidedef
+    pl->source = texturetranslation[s->toptexture];
+
+    // Horizontal offset is turned into an angle offset,
+    // to allow sky rotation as well as careful positioning.
+    // However, the offset is scaled very small, so that it
+    // allows a long-period of sky rotation.
+
+    pl->skyangle = s->textureoffset;
+
+    // Vertical offset allows careful sky positioning.
+
+    pl->skymid = s->rowoffset - 28*FRACUNIT;
+
+    // We sometimes flip the picture horizontally.
+    //
+    // Doom always flipped the picture, so we make it optional,
+    // to make it easier to use the new feature, while to still
+    // allow old sky textures to be used.
+
+    pl->skyflip = l->special==272 ? 0u : ~0u;
+  }
+  else if (pl->picnum == skyflatnum)
+  {    // Normal Doom sky, only one allowed per level
+    pl->source = skytexture;          // Default texture
+    pl->skyangle = 0;
+    pl->skymid = skytexturemid;       // Default y-offset
+    pl->skyflip = 0;                  // Doom flips it
+  }
+  else
+    pl->source = firstflat + flattranslation[pl->picnum];
+}
+
 //
 // R_FindPlane
 //
@@ -268,7 +340,7 @@ visplane_t IRAM_ATTR *R_FindPlane(fixed_t height, int picnum, int lightlevel,
   // New visplane algorithm uses hash table -- killough
   hash = visplane_hash(picnum,lightlevel,height);
 
-  for (check=visplanes[hash]; check; check=check->next)  // killough
+  for (check=visplanes[renderthread][hash]; check; check=check->next)  // killough
     if (height == check->height &&
         picnum == check->picnum &&
         lightlevel == check->lightlevel &&
@@ -285,6 +357,7 @@ visplane_t IRAM_ATTR *R_FindPlane(fixed_t height, int picnum, int lightlevel,
   check->maxx = -1;
   check->xoffs = xoffs;               // killough 2/28/98: Save offsets
   check->yoffs = yoffs;
+  R_SetPlaneSource(check);
 
   memset (check->top, 0xff, sizeof check->top);
 
@@ -327,13 +400,13 @@ static void R_MakeSpans(int x, unsigned int t1, unsigned int b1,
                         draw_span_vars_t *dsvars)
 {
   for (; t1 < t2 && t1 <= b1; t1++)
-    R_MapPlane(t1, spanstart[t1], x-1, dsvars);
+    R_MapPlane(t1, spanstart[renderthread][t1], x-1, dsvars);
   for (; b1 > b2 && b1 >= t1; b1--)
-    R_MapPlane(b1, spanstart[b1] ,x-1, dsvars);
+    R_MapPlane(b1, spanstart[renderthread][b1] ,x-1, dsvars);
   while (t2 < t1 && t2 <= b2)
-    spanstart[t2++] = x;
+    spanstart[renderthread][t2++] = x;
   while (b2 > b1 && b2 >= t2)
-    spanstart[b2--] = x;
+    spanstart[renderthread][b2--] = x;
 }
 
 // New function, by Lee Killough
@@ -352,49 +425,11 @@ static void IRAM_ATTR R_DoDrawPlane(visplane_t *pl)
       const rpatch_t *tex_patch;
       angle_t an, flip;
 
-      // killough 10/98: allow skies to come from sidedefs.
-      // Allows scrolling and/or animated skies, as well as
-      // arbitrary multiple skies per level without having
-      // to use info lumps.
-
-      an = viewangle;
-
-      if (pl->picnum & PL_SKYFLAT)
-      {
-        // Sky Linedef
-        const line_t *l = &lines[pl->picnum & ~PL_SKYFLAT];
-
-        // Sky transferred from first sidedef
-        const side_t *s = *l->sidenum + sides;
-
-        // Texture comes from upper texture of reference sidedef
-        texture = texturetranslation[s->toptexture];
-
-        // Horizontal offset is turned into an angle offset,
-        // to allow sky rotation as well as careful positioning.
-        // However, the offset is scaled very small, so that it
-        // allows a long-period of sky rotation.
-
-        an += s->textureoffset;
-
-        // Vertical offset allows careful sky positioning.
-
-        dcvars.texturemid = s->rowoffset - 28*FRACUNIT;
-
-        // We sometimes flip the picture horizontally.
-        //
-        // Doom always flipped the picture, so we make it optional,
-        // to make it easier to use the new feature, while to still
-        // allow old sky textures to be used.
-
-        flip = l->special==272 ? 0u : ~0u;
-      }
-      else
-      {    // Normal Doom sky, only one allowed per level
-        dcvars.texturemid = skytexturemid;    // Default y-offset
-        texture = skytexture;             // Default texture
-        flip = 0;                         // Doom flips it
-      }
+      // Texture, offsets and flip from R_SetPlaneSource
+      texture = pl->source;
+      an = viewangle + pl->skyangle;
+      dcvars.texturemid = pl->skymid;
+      flip = pl->skyflip;
 
       /* Sky is always drawn full bright, i.e. colormaps[0] is used.
        * Because of this hack, sky is not affected by INVUL inverse mapping.
@@ -429,7 +464,7 @@ static void IRAM_ATTR R_DoDrawPlane(visplane_t *pl)
       int stop, light;
       draw_span_vars_t dsvars;
 
-      dsvars.source = W_CacheLumpNum(firstflat + flattranslation[pl->picnum]);
+      dsvars.source = W_CacheLumpNum(pl->source);
 
       xoffs = pl->xoffs;  // killough 2/28/98: Add offsets
       yoffs = pl->yoffs;
@@ -450,7 +485,7 @@ static void IRAM_ATTR R_DoDrawPlane(visplane_t *pl)
          R_MakeSpans(x,pl->top[x-1],pl->bottom[x-1],
                      pl->top[x],pl->bottom[x], &dsvars);
 
-      W_UnlockLumpNum(firstflat + flattranslation[pl->picnum]);
+      W_UnlockLumpNum(pl->source);
     }
   }
 }
@@ -464,7 +499,17 @@ void R_DrawPlanes (void)
 {
   visplane_t *pl;
   int i;
+
+  // texture calculation
+  // (not in R_ClearPlanes: with PIPELINE_RENDER the next frame's may
+  // have run by the time these planes are drawn)
+  memset (cachedheight[renderthread], 0, sizeof(cachedheight[0]));
+
+  // scale will be unit scale at SCREENWIDTH/2 distance
+  basexscale = FixedDiv (viewsin,projection);
+  baseyscale = FixedDiv (viewcos,projection);
+
   for (i=0;i<MAXVISPLANES;i++)
-    for (pl=visplanes[i]; pl; pl=pl->next, rendered_visplanes++)
+    for (pl=visplanes[renderthread][i]; pl; pl=pl->next, rendered_visplanes++)
       R_DoDrawPlane(pl);
 }
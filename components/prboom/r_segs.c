@@ -51,46 +51,47 @@
 // killough 1/6/98: replaced globals with statics where appropriate
 
 // True if any of the segs textures might be visible.
-static boolean  segtextured;
-static boolean  markfloor;      // False if the back side is the same plane.
-static boolean  markceiling;
-static boolean  maskedtexture;
-static int      toptexture;
-static int      bottomtexture;
-static int      midtexture;
+static R_LOCAL boolean  segtextured;
+static R_LOCAL boolean  markfloor;      // False if the back side is the same plane.
+static R_LOCAL boolean  markceiling;
+static R_LOCAL boolean  maskedtexture;
+static R_LOCAL int      toptexture;
+static R_LOCAL int      bottomtexture;
+static R_LOCAL int      midtexture;
 
-static fixed_t  toptexheight, midtexheight, bottomtexheight; // cph
+static R_LOCAL fixed_t  toptexheight, midtexheight, bottomtexheight; // cph
 
-angle_t         rw_normalangle; // angle to line origin
-int             rw_angle1;
-fixed_t         rw_distance;
+R_LOCAL angle_t         rw_normalangle; // angle to line origin
+R_LOCAL int             rw_angle1;
+R_LOCAL int             rw_segx1, rw_segx2;
+R_LOCAL fixed_t         rw_distance;
 
 //
 // regular wall
 //
-static int      rw_x;
-static int      rw_stopx;
-static angle_t  rw_centerangle;
-static fixed_t  rw_offset;
-static fixed_t  rw_scale;
-static fixed_t  rw_scalestep;
-static fixed_t  rw_midtexturemid;
-static fixed_t  rw_toptexturemid;
-static fixed_t  rw_bottomtexturemid;
-static int      rw_lightlevel;
-static int      worldtop;
-static int      worldbottom;
-static int      worldhigh;
-static int      worldlow;
-static fixed_t  pixhigh;
-static fixed_t  pixlow;
-static fixed_t  pixhighstep;
-static fixed_t  pixlowstep;
-static fixed_t  topfrac;
-static fixed_t  topstep;
-static fixed_t  bottomfrac;
-static fixed_t  bottomstep;
-static int      *maskedtexturecol; // dropoff overflow
+static R_LOCAL int      rw_x;
+static R_LOCAL int      rw_stopx;
+static R_LOCAL angle_t  rw_centerangle;
+static R_LOCAL fixed_t  rw_offset;
+static R_LOCAL fixed_t  rw_scale;
+static R_LOCAL fixed_t  rw_scalestep;
+static R_LOCAL fixed_t  rw_midtexturemid;
+static R_LOCAL fixed_t  rw_toptexturemid;
+static R_LOCAL fixed_t  rw_bottomtexturemid;
+static R_LOCAL int      rw_lightlevel;
+static R_LOCAL int      worldtop;
+static R_LOCAL int      worldbottom;
+static R_LOCAL int      worldhigh;
+static R_LOCAL int      worldlow;
+static R_LOCAL fixed_t  pixhigh;
+static R_LOCAL fixed_t  pixlow;
+static R_LOCAL fixed_t  pixhighstep;
+static R_LOCAL fixed_t  pixlowstep;
+static R_LOCAL fixed_t  topfrac;
+static R_LOCAL fixed_t  topstep;
+static R_LOCAL fixed_t  bottomfrac;
+static R_LOCAL fixed_t  bottomstep;
+static R_LOCAL int      *maskedtexturecol; // dropoff overflow
 
 //
 // R_ScaleFromGlobalAngle
@@ -120,7 +121,6 @@ static fixed_t R_ScaleFromGlobalAngle(angle_t visangle)
 void IRAM_ATTR R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
 {
   int      texnum;
-  sector_t tempsec;      // killough 4/13/98
   const rpatch_t *patch;
   R_DrawColumn_f colfunc;
   draw_column_vars_t dcvars;
@@ -137,25 +137,19 @@ void IRAM_ATTR R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
   // killough 4/11/98: draw translucent 2s normal textures
 
   colfunc = R_GetDrawColumnFunc(RDC_PIPELINE_STANDARD, drawvars.filterwall, drawvars.filterz);
-  if (curline->linedef->tranlump >= 0 && general_translucency)
+  if (ds->maskedtranlump >= 0 && general_translucency)
     {
       colfunc = R_GetDrawColumnFunc(RDC_PIPELINE_TRANSLUCENT, drawvars.filterwall, drawvars.filterz);
       tranmap = main_tranmap;
-      if (curline->linedef->tranlump > 0)
-        tranmap = W_CacheLumpNum(curline->linedef->tranlump-1);
+      if (ds->maskedtranlump > 0)
+        tranmap = W_CacheLumpNum(ds->maskedtranlump-1);
     }
   // killough 4/11/98: end translucent 2s normal code
 
-  frontsector = curline->frontsector;
-  backsector = curline->backsector;
-
-  // cph 2001/11/25 - middle textures did not animate in v1.2
-  texnum = curline->sidedef->midtexture;
-  if (!comp[comp_maskedanim])
-    texnum = texturetranslation[texnum];
-
-  // killough 4/13/98: get correct lightlevel for 2s normal textures
-  rw_lightlevel = R_FakeFlat(frontsector, &tempsec, NULL, NULL, false) ->lightlevel;
+  // Texture, light level and position from R_StoreWallRange
+  texnum = ds->maskedtexnum;
+  rw_lightlevel = ds->maskedlight;
+  dcvars.texturemid = ds->maskedtexturemid;
 
   maskedtexturecol = ds->maskedtexturecol;
 
@@ -164,22 +158,6 @@ void IRAM_ATTR R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
   mfloorclip = ds->sprbottomclip;
   mceilingclip = ds->sprtopclip;
 
-  // find positioning
-  if (curline->linedef->flags & ML_DONTPEGBOTTOM)
-    {
-      dcvars.texturemid = frontsector->floorheight > backsector->floorheight
-        ? frontsector->floorheight : backsector->floorheight;
-      dcvars.texturemid = dcvars.texturemid + textureheight[texnum] - viewz;
-    }
-  else
-    {
-      dcvars.texturemid =frontsector->ceilingheight<backsector->ceilingheight
-        ? frontsector->ceilingheight : backsector->ceilingheight;
-      dcvars.texturemid = dcvars.texturemid - viewz;
-    }
-
-  dcvars.texturemid += curline->sidedef->rowoffset;
-
   if (fixedcolormap) {
     dcvars.colormap = fixedcolormap;
     dcvars.nextcolormap = dcvars.colormap; // for filtering -- POPE
@@ -245,8 +223,8 @@ void IRAM_ATTR R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
       }
 
   // Except for main_tranmap, mark others purgable at this point
-  if (curline->linedef->tranlump > 0 && general_translucency)
-    W_UnlockLumpNum(curline->linedef->tranlump-1); // cph - unlock it
+  if (ds->maskedtranlump > 0 && general_translucency)
+    W_UnlockLumpNum(ds->maskedtranlump-1); // cph - unlock it
 
   R_UnlockTextureCompositePatchNum(texnum);
 
@@ -262,7 +240,7 @@ void IRAM_ATTR R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
 
 #define HEIGHTBITS 12
 #define HEIGHTUNIT (1<<HEIGHTBITS)
-static int didsolidcol; /* True if at least one column was marked solid */
+static R_LOCAL int didsolidcol; /* True if at least one column was marked solid */
 
 static void IRAM_ATTR R_RenderSegLoop (void)
 {
@@ -437,7 +415,10 @@ static void IRAM_ATTR R_RenderSegLoop (void)
     // add this info to the solid columns array for r_bsp.c
     if ((markceiling || markfloor) &&
         (floorclip[rw_x] <= ceilingclip[rw_x] + 1)) {
-      solidcol[rw_x] = 1; didsolidcol = 1;
+      unsigned *cols = &solidcol[renderthread][rw_x >> 5];
+      if ((*cols |= 1u << (rw_x & 31)) == ~0u)
+        solidcolsum |= 1u << (rw_x >> 5);
+      didsolidcol = 1;
     }
 
           // save texturecol for backdrawing of masked mid texture
@@ -469,6 +450,41 @@ static fixed_t R_PointToDist(fixed_t x, fixed_t y)
                                 + ANG90) >> ANGLETOFINESHIFT]);
 }
 
+//
+// R_StoreMaskedTexture
+// Work out now what R_RenderMaskedSegRange needs from the level for the
+// masked middle texture of ds_p, moved here from there. The game may have
+// run on by the time it is drawn (PIPELINE_RENDER).
+//
+
+static void R_StoreMaskedTexture(void)
+{
+  sector_t tempsec;      // killough 4/13/98
+  sector_t *front = curline->frontsector;
+  const sector_t *back = curline->backsector;
+  int texnum;
+
+  // cph 2001/11/25 - middle textures did not animate in v1.2
+  texnum = sidedef->midtexture;
+  if (!comp[comp_maskedanim])
+    texnum = texturetranslation[texnum];
+  ds_p->maskedtexnum = texnum;
+
+  // killough 4/13/98: get correct lightlevel for 2s normal textures
+  ds_p->maskedlight = R_FakeFlat(front, &tempsec, NULL, NULL, false)->lightlevel;
+
+  ds_p->maskedtranlump = linedef->tranlump;
+
+  // find positioning
+  if (linedef->flags & ML_DONTPEGBOTTOM)
+    ds_p->maskedtexturemid = (front->floorheight > back->floorheight
+      ? front->floorheight : back->floorheight) + textureheight[texnum] - viewz;
+  else
+    ds_p->maskedtexturemid = (front->ceilingheight < back->ceilingheight
+      ? front->ceilingheight : back->ceilingheight) - viewz;
+  ds_p->maskedtexturemid += sidedef->rowoffset;
+}
+
 //
 // R_StoreWallRange
 // A wall segment will be drawn
@@ -476,8 +492,9 @@ static fixed_t R_PointToDist(fixed_t x, fixed_t y)
 //
 void R_StoreWallRange(const int start, const int stop)
 {
-  fixed_t hyp;
+  fixed_t hyp, segscale;
   angle_t offsetangle;
+  int stepx;                  // column the edges are stepped from
 
   if (ds_p == drawsegs+maxdrawsegs)   // killough 1/98 -- fix 2s line HOM
     {
@@ -532,8 +549,6 @@ void R_StoreWallRange(const int start, const int stop)
   rw_stopx = stop+1;
 
   {     // killough 1/6/98, 2/1/98: remove limit on openings
-    extern int *openings; // dropoff overflow
-    extern size_t maxopenings;
     size_t pos = lastopening - openings;
     size_t need = (rw_stopx - start)*4 + pos;
     if (need > maxopenings)
@@ -565,7 +580,23 @@ void R_StoreWallRange(const int start, const int stop)
 
   // calculate scale at both ends and step
 
-  ds_p->scale1 = rw_scale =
+#ifdef SPLIT_RENDER
+  // The step is taken over the whole seg and every edge is stepped from
+  // its first column, so a column comes out the same on either side of
+  // the cut between the render threads, wherever the cut is this frame.
+  stepx = rw_segx1;
+  segscale = R_ScaleFromGlobalAngle (viewangle + xtoviewangle[stepx]);
+  rw_scalestep = 0;
+  if (rw_segx2 > stepx)
+    rw_scalestep = (R_ScaleFromGlobalAngle (viewangle + xtoviewangle[rw_segx2])
+                    - segscale) / (rw_segx2-stepx);
+
+  ds_p->scale1 = rw_scale = segscale + (start-stepx)*rw_scalestep;
+  ds_p->scale2 = rw_scale + (stop-start)*rw_scalestep;
+  ds_p->scalestep = rw_scalestep;
+#else
+  stepx = start;
+  ds_p->scale1 = segscale = rw_scale =
     R_ScaleFromGlobalAngle (viewangle + xtoviewangle[start]);
 
   if (stop > start)
@@ -575,6 +606,7 @@ void R_StoreWallRange(const int start, const int stop)
     }
   else
     ds_p->scale2 = ds_p->scale1;
+#endif
 
   // calculate texture boundaries
   //  and decide if floor / ceiling marks are needed
@@ -727,6 +759,7 @@ void R_StoreWallRange(const int start, const int stop)
           maskedtexture = true;
           ds_p->maskedtexturecol = maskedtexturecol = lastopening - rw_x;
           lastopening += rw_stopx - rw_x;
+          R_StoreMaskedTexture();
         }
     }
 
@@ -767,11 +800,14 @@ void R_StoreWallRange(const int start, const int stop)
   worldtop >>= 4;
   worldbottom >>= 4;
 
+  // from stepx, as above
   topstep = -FixedMul (rw_scalestep, worldtop);
-  topfrac = (centeryfrac>>4) - FixedMul (worldtop, rw_scale);
+  topfrac = (centeryfrac>>4) - FixedMul (worldtop, segscale)
+    + (start-stepx)*topstep;
 
   bottomstep = -FixedMul (rw_scalestep,worldbottom);
-  bottomfrac = (centeryfrac>>4) - FixedMul (worldbottom, rw_scale);
+  bottomfrac = (centeryfrac>>4) - FixedMul (worldbottom, segscale)
+    + (start-stepx)*bottomstep;
 
   if (backsector)
     {
@@ -780,13 +816,15 @@ void R_StoreWallRange(const int start, const int stop)
 
       if (worldhigh < worldtop)
         {
-          pixhigh = (centeryfrac>>4) - FixedMul (worldhigh, rw_scale);
           pixhighstep = -FixedMul (rw_scalestep,worldhigh);
+          pixhigh = (centeryfrac>>4) - FixedMul (worldhigh, segscale)
+            + (start-stepx)*pixhighstep;
         }
       if (worldlow > worldbottom)
         {
-          pixlow = (centeryfrac>>4) - FixedMul (worldlow, rw_scale);
           pixlowstep = -FixedMul (rw_scalestep,worldlow);
+          pixlow = (centeryfrac>>4) - FixedMul (worldlow, segscale)
+            + (start-stepx)*pixlowstep;
         }
     }
 
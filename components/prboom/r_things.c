@@ -40,6 +40,7 @@
 #include "r_things.h"
 #include "r_fps.h"
 #include "v_video.h"
+#include "d_snapshot.h"
 #include "lprintf.h"
 
 #define MINZ        (FRACUNIT*4)
@@ -164,7 +165,11 @@ static void R_InitSpriteDefs(const char * const * namelist)
 
   numsprites = i;
 
-  sprites = Z_Malloc(numsprites *sizeof(*sprites), PU_STATIC, NULL);
+  if (D_SnapshotSprites(namelist))
+    return;
+
+  // Zeroed, as names without any lumps are left alone below
+  sprites = Z_Calloc(numsprites, sizeof(*sprites), PU_STATIC, NULL);
 
   // Create hash table based on just the first four letters of each sprite
   // killough 1/31/98
@@ -262,8 +267,10 @@ static void R_InitSpriteDefs(const char * const * namelist)
 // GAME FUNCTIONS
 //
 
-static vissprite_t *vissprites, **vissprite_ptrs;  // killough
-static size_t num_vissprite, num_vissprite_alloc, num_vissprite_ptrs;
+R_LOCAL vissprite_t *vissprites;          // killough
+static R_LOCAL vissprite_t **vissprite_ptrs;
+R_LOCAL size_t num_vissprite, num_vissprite_alloc;
+static R_LOCAL size_t num_vissprite_ptrs;
 
 //
 // R_InitSprites
@@ -316,10 +323,10 @@ static vissprite_t *R_NewVisSprite(void)
 //  in posts/runs of opaque pixels.
 //
 
-int   *mfloorclip;   // dropoff overflow
-int   *mceilingclip; // dropoff overflow
-fixed_t spryscale;
-fixed_t sprtopscreen;
+R_LOCAL int   *mfloorclip;   // dropoff overflow
+R_LOCAL int   *mceilingclip; // dropoff overflow
+R_LOCAL fixed_t spryscale;
+R_LOCAL fixed_t sprtopscreen;
 
 void R_DrawMaskedColumn(
   const rpatch_t *patch,
@@ -565,8 +572,8 @@ static void R_ProjectSprite (mobj_t* thing, int lightlevel)
     R_UnlockPatchNum(lump+firstspritelump);
   }
 
-  // off the side?
-  if (x1 > viewwidth || x2 < 0)
+  // off the side? (of this render thread's columns)
+  if (x1 > viewstopx || x2 < viewstartx)
     return;
 
   // killough 4/9/98: clip things which are out of view due to height
@@ -614,6 +621,17 @@ static void R_ProjectSprite (mobj_t* thing, int lightlevel)
 #endif
   // killough 3/27/98: save sector for special clipping later
   vis->heightsec = heightsec;
+  if (heightsec != -1)
+    {
+      vis->phs = viewplayer->mo->subsector->sector->heightsec;
+      vis->hsfloorheight = sectors[heightsec].floorheight;
+      vis->hsceilingheight = sectors[heightsec].ceilingheight;
+      if (vis->phs != -1)
+        {
+          vis->phsfloorheight = sectors[vis->phs].floorheight;
+          vis->phsceilingheight = sectors[vis->phs].ceilingheight;
+        }
+    }
 
   vis->mobjflags = thing->flags;
 // proff 11/06/98: Changed for high-res
@@ -623,8 +641,8 @@ static void R_ProjectSprite (mobj_t* thing, int lightlevel)
   vis->gz = fz;
   vis->gzt = gzt;                          // killough 3/27/98
   vis->texturemid = vis->gzt - viewz;
-  vis->x1 = x1 < 0 ? 0 : x1;
-  vis->x2 = x2 >= viewwidth ? viewwidth-1 : x2;
+  vis->x1 = x1 < viewstartx ? viewstartx : x1;
+  vis->x2 = x2 >= viewstopx ? viewstopx-1 : x2;
   iscale = FixedDiv (FRACUNIT, xscale);
 
   if (flip)
@@ -670,11 +688,11 @@ void R_AddSprites(subsector_t* subsec, int lightlevel)
   //  subsectors during BSP building.
   // Thus we check whether its already added.
 
-  if (sec->validcount == validcount)
+  if (sec->spritevalidcount[renderthread] == validcount)
     return;
 
   // Well, now it will be done.
-  sec->validcount = validcount;
+  sec->spritevalidcount[renderthread] = validcount;
 
   // Handle all things in sector.
 
@@ -683,10 +701,15 @@ void R_AddSprites(subsector_t* subsec, int lightlevel)
 }
 
 //
-// R_DrawPSprite
+// R_ProjectPSprite
+// Psprites are projected along with the rest of the frame and drawn by
+// R_DrawPlayerSprites, so drawing them doesn't look at the player again.
 //
 
-static void R_DrawPSprite (pspdef_t *psp, int lightlevel)
+static vissprite_t pspritevis[RENDER_THREADS][NUMPSPRITES];
+static int numpspritevis[RENDER_THREADS];
+
+static void R_ProjectPSprite (pspdef_t *psp, int lightlevel)
 {
   int           x1, x2;
   spritedef_t   *sprdef;
@@ -738,7 +761,7 @@ static void R_DrawPSprite (pspdef_t *psp, int lightlevel)
   }
 
   // off the side
-  if (x2 < 0 || x1 > viewwidth)
+  if (x2 < viewstartx || x1 > viewstopx)
     return;
 
   // store information in a vissprite
@@ -747,8 +770,8 @@ static void R_DrawPSprite (pspdef_t *psp, int lightlevel)
    // killough 12/98: fix psprite positioning problem
   vis->texturemid = (BASEYCENTER<<FRACBITS) /* +  FRACUNIT/2 */ -
                     (psp->sy-topoffset);
-  vis->x1 = x1 < 0 ? 0 : x1;
-  vis->x2 = x2 >= viewwidth ? viewwidth-1 : x2;
+  vis->x1 = x1 < viewstartx ? viewstartx : x1;
+  vis->x2 = x2 >= viewstopx ? viewstopx-1 : x2;
 // proff 11/06/98: Added for high-res
   vis->scale = pspriteyscale;
 
@@ -783,7 +806,7 @@ static void R_DrawPSprite (pspdef_t *psp, int lightlevel)
   // proff 11/99: don't use software stuff in OpenGL
   if (V_GetMode() != VID_MODEGL)
   {
-    R_DrawVisSprite(vis, vis->x1, vis->x2);
+    pspritevis[renderthread][numpspritevis[renderthread]++] = *vis;
   }
 #ifdef GL_DOOM
   else
@@ -812,22 +835,44 @@ static void R_DrawPSprite (pspdef_t *psp, int lightlevel)
 }
 
 //
-// R_DrawPlayerSprites
+// R_ProjectPlayerSprites
 //
 
-void R_DrawPlayerSprites(void)
+void R_ProjectPlayerSprites(void)
 {
   int i, lightlevel = viewplayer->mo->subsector->sector->lightlevel;
   pspdef_t *psp;
 
-  // clip to screen bounds
-  mfloorclip = screenheightarray;
-  mceilingclip = negonearray;
+  numpspritevis[renderthread] = 0;
 
   // add all active psprites
   for (i=0, psp=viewplayer->psprites; i<NUMPSPRITES; i++,psp++)
     if (psp->state)
-      R_DrawPSprite (psp, lightlevel);
+      R_ProjectPSprite (psp, lightlevel);
+}
+
+//
+// R_DrawPlayerSprites
+//
+
+void R_DrawPlayerSprites(void)
+{
+  int i;
+
+  // OpenGL draws them as they are projected
+  if (V_GetMode() == VID_MODEGL)
+    {
+      R_ProjectPlayerSprites();
+      return;
+    }
+
+  // clip to screen bounds
+  mfloorclip = screenheightarray;
+  mceilingclip = negonearray;
+
+  for (i=0; i<numpspritevis[renderthread]; i++)
+    R_DrawVisSprite(&pspritevis[renderthread][i],
+                    pspritevis[renderthread][i].x1, pspritevis[renderthread][i].x2);
 }
 
 //
@@ -992,27 +1037,27 @@ static void R_DrawSprite (vissprite_t* spr)
   if (spr->heightsec != -1)  // only things in specially marked sectors
     {
       fixed_t h,mh;
-      int phs = viewplayer->mo->subsector->sector->heightsec;
-      if ((mh = sectors[spr->heightsec].floorheight) > spr->gz &&
+      int phs = spr->phs;
+      if ((mh = spr->hsfloorheight) > spr->gz &&
           (h = centeryfrac - FixedMul(mh-=viewz, spr->scale)) >= 0 &&
           (h >>= FRACBITS) < viewheight) {
-        if (mh <= 0 || (phs != -1 && viewz > sectors[phs].floorheight))
+        if (mh <= 0 || (phs != -1 && viewz > spr->phsfloorheight))
           {                          // clip bottom
             for (x=spr->x1 ; x<=spr->x2 ; x++)
               if (clipbot[x] == -2 || h < clipbot[x])
                 clipbot[x] = h;
           }
         else                        // clip top
-    if (phs != -1 && viewz <= sectors[phs].floorheight) // killough 11/98
+    if (phs != -1 && viewz <= spr->phsfloorheight) // killough 11/98
       for (x=spr->x1 ; x<=spr->x2 ; x++)
         if (cliptop[x] == -2 || h > cliptop[x])
     cliptop[x] = h;
       }
 
-      if ((mh = sectors[spr->heightsec].ceilingheight) < spr->gzt &&
+      if ((mh = spr->hsceilingheight) < spr->gzt &&
           (h = centeryfrac - FixedMul(mh-viewz, spr->scale)) >= 0 &&
           (h >>= FRACBITS) < viewheight) {
-        if (phs != -1 && viewz >= sectors[phs].ceilingheight)
+        if (phs != -1 && viewz >= spr->phsceilingheight)
           {                         // clip bottom
             for (x=spr->x1 ; x<=spr->x2 ; x++)
               if (clipbot[x] == -2 || h < clipbot[x])
@@ -1031,10 +1076,10 @@ static void R_DrawSprite (vissprite_t* spr)
 
   for (x = spr->x1 ; x<=spr->x2 ; x++) {
     if (clipbot[x] == -2)
-      clipbot[x] = viewheight;
+      clipbot[x] = screenheightarray[x];
 
     if (cliptop[x] == -2)
-      cliptop[x] = -1;
+      cliptop[x] = negonearray[x];
   }
 
   mfloorclip = clipbot;
@@ -849,7 +849,7 @@ void ST_Drawer(boolean statusbaron, boolean refresh)
   ST_doPaletteStuff();  // Do red-/gold-shifts from damage/items
 
   if (statusbaron) {
-    if (st_firsttime || (V_GetMode() == VID_MODEGL))
+    if (st_firsttime || (V_GetMode() == VID_MODEGL) || use_doublebuffer)
       ST_doRefresh();     /* If just after ST_Start(), refresh all */
     else
       ST_diffDraw();      /* Otherwise, update as little as possible */
@@ -138,6 +138,17 @@ static void FUNC_V_CopyRect(int srcx, int srcy, int srcscrn, int width,
     I_Error ("V_CopyRect: Bad arguments");
 #endif
 
+#ifdef COLUMN_MAJOR_SCREENS
+  src = screens[srcscrn].data+screens[srcscrn].byte_pitch*srcx+srcy*V_GetPixelDepth();
+  dest = screens[destscrn].data+screens[destscrn].byte_pitch*destx+desty*V_GetPixelDepth();
+
+  for ( ; width>0 ; width--)
+    {
+      memcpy (dest, src, height*V_GetPixelDepth());
+      src += screens[srcscrn].byte_pitch;
+      dest += screens[destscrn].byte_pitch;
+    }
+#else
   src = screens[srcscrn].data+screens[srcscrn].byte_pitch*srcy+srcx*V_GetPixelDepth();
   dest = screens[destscrn].data+screens[destscrn].byte_pitch*desty+destx*V_GetPixelDepth();
 
@@ -147,6 +158,7 @@ static void FUNC_V_CopyRect(int srcx, int srcy, int srcscrn, int width,
       src += screens[srcscrn].byte_pitch;
       dest += screens[destscrn].byte_pitch;
     }
+#endif
 }
 
 /*
@@ -172,9 +184,16 @@ static void FUNC_V_DrawBackground(const char* flatname, int scrn)
     byte *dest = screens[scrn].data;
 
     while (height--) {
+#ifdef COLUMN_MAJOR_SCREENS
+      int i;
+      for (i=0; i<width; i++) {
+        dest[i*V_XSTEP(screens[scrn].byte_pitch)] = src[i];
+      }
+#else
       memcpy (dest, src, width);
+#endif
       src += width;
-      dest += screens[scrn].byte_pitch;
+      dest += V_YSTEP(screens[scrn].byte_pitch);
     }
   } else if (V_GetMode() == VID_MODE15) {
     unsigned short *dest = (unsigned short *)screens[scrn].data;
@@ -182,10 +201,10 @@ static void FUNC_V_DrawBackground(const char* flatname, int scrn)
     while (height--) {
       int i;
       for (i=0; i<width; i++) {
-        dest[i] = VID_PAL15(src[i], VID_COLORWEIGHTMASK);
+        dest[i*V_XSTEP(screens[scrn].short_pitch)] = VID_PAL15(src[i], VID_COLORWEIGHTMASK);
       }
       src += width;
-      dest += screens[scrn].short_pitch;
+      dest += V_YSTEP(screens[scrn].short_pitch);
     }
   } else if (V_GetMode() == VID_MODE16) {
     unsigned short *dest = (unsigned short *)screens[scrn].data;
@@ -193,10 +212,10 @@ static void FUNC_V_DrawBackground(const char* flatname, int scrn)
     while (height--) {
       int i;
       for (i=0; i<width; i++) {
-        dest[i] = VID_PAL16(src[i], VID_COLORWEIGHTMASK);
+        dest[i*V_XSTEP(screens[scrn].short_pitch)] = VID_PAL16(src[i], VID_COLORWEIGHTMASK);
       }
       src += width;
-      dest += screens[scrn].short_pitch;
+      dest += V_YSTEP(screens[scrn].short_pitch);
     }
   } else if (V_GetMode() == VID_MODE32) {
     unsigned int *dest = (unsigned int *)screens[scrn].data;
@@ -204,10 +223,10 @@ static void FUNC_V_DrawBackground(const char* flatname, int scrn)
     while (height--) {
       int i;
       for (i=0; i<width; i++) {
-        dest[i] = VID_PAL32(src[i], VID_COLORWEIGHTMASK);
+        dest[i*V_XSTEP(screens[scrn].int_pitch)] = VID_PAL32(src[i], VID_COLORWEIGHTMASK);
       }
       src += width;
-      dest += screens[scrn].int_pitch;
+      dest += V_YSTEP(screens[scrn].int_pitch);
     }
   }
   /* end V_DrawBlock */
@@ -277,7 +296,9 @@ static void IRAM_ATTR V_DrawMemPatch(int x, int y, int scrn, const rpatch_t *pat
 
   if (V_GetMode() == VID_MODE8 && !(flags & VPT_STRETCH)) {
     int             col;
-    byte           *desttop = screens[scrn].data+y*screens[scrn].byte_pitch+x*V_GetPixelDepth();
+    const int       xstep = V_XSTEP(screens[scrn].byte_pitch);
+    const int       ystep = V_YSTEP(screens[scrn].byte_pitch);
+    byte           *desttop = screens[scrn].data+V_PIXOFS(x, y, screens[scrn].byte_pitch);
     unsigned int    w = patch->width;
 
     if (y<0 || y+patch->height > ((flags & VPT_STRETCH) ? 200 :  SCREENHEIGHT)) {
@@ -289,7 +310,7 @@ static void IRAM_ATTR V_DrawMemPatch(int x, int y, int scrn, const rpatch_t *pat
 
     w--; // CPhipps - note: w = width-1 now, speeds up flipping
 
-    for (col=0 ; (unsigned int)col<=w ; desttop++, col++, x++) {
+    for (col=0 ; (unsigned int)col<=w ; desttop+=xstep, col++, x++) {
       int i;
       const int colindex = (flags & VPT_FLIP) ? (w - col) : (col);
       const rcolumn_t *column = R_GetPatchColumn(patch, colindex);
@@ -305,7 +326,7 @@ static void IRAM_ATTR V_DrawMemPatch(int x, int y, int scrn, const rpatch_t *pat
         // killough 2/21/98: Unrolled and performance-tuned
 
         const byte *source = column->pixels + post->topdelta;
-        byte *dest = desttop + post->topdelta*screens[scrn].byte_pitch;
+        byte *dest = desttop + post->topdelta*ystep;
         int count = post->length;
 
         if (!(flags & VPT_TRANS)) {
@@ -315,19 +336,19 @@ static void IRAM_ATTR V_DrawMemPatch(int x, int y, int scrn, const rpatch_t *pat
               s0 = source[0];
               s1 = source[1];
               dest[0] = s0;
-              dest[screens[scrn].byte_pitch] = s1;
-              dest += screens[scrn].byte_pitch*2;
+              dest[ystep] = s1;
+              dest += ystep*2;
               s0 = source[2];
               s1 = source[3];
               source += 4;
               dest[0] = s0;
-              dest[screens[scrn].byte_pitch] = s1;
-              dest += screens[scrn].byte_pitch*2;
+              dest[ystep] = s1;
+              dest += ystep*2;
             } while ((count-=4)>=0);
           if (count+=4)
             do {
               *dest = *source++;
-              dest += screens[scrn].byte_pitch;
+              dest += ystep;
             } while (--count);
         } else {
           // CPhipps - merged translation code here
@@ -339,21 +360,21 @@ static void IRAM_ATTR V_DrawMemPatch(int x, int y, int scrn, const rpatch_t *pat
               s0 = trans[s0];
               s1 = trans[s1];
               dest[0] = s0;
-              dest[screens[scrn].byte_pitch] = s1;
-              dest += screens[scrn].byte_pitch*2;
+              dest[ystep] = s1;
+              dest += ystep*2;
               s0 = source[2];
               s1 = source[3];
               s0 = trans[s0];
               s1 = trans[s1];
               source += 4;
               dest[0] = s0;
-              dest[screens[scrn].byte_pitch] = s1;
-              dest += screens[scrn].byte_pitch*2;
+              dest[ystep] = s1;
+              dest += ystep*2;
             } while ((count-=4)>=0);
           if (count+=4)
             do {
               *dest = trans[*source++];
-              dest += screens[scrn].byte_pitch;
+              dest += ystep;
             } while (--count);
         }
       }
@@ -519,11 +540,9 @@ void V_UpdateTrueColorPalette(video_mode_t mode) {
   int pplump = W_GetNumForName("PLAYPAL");
   const byte *pal = W_CacheLumpNum(pplump);
   // opengl doesn't use the gamma
-//  const byte *const gtable = 
-  //  (const byte *)GAMMATBL_dat + 
-    //(V_GetMode() == VID_MODEGL ? 0 : 256*(usegamma)) ;
-
-  const byte *const gtable = (const byte *)GAMMATBL_dat;
+  const byte *const gtable =
+    (const byte *)GAMMATBL_dat +
+    (V_GetMode() == VID_MODEGL ? 0 : 256*(usegamma)) ;
 
   int numPals = W_LumpLength(pplump) / (3*256);
   const float dontRoundAbove = 220;
@@ -590,7 +609,7 @@ void V_UpdateTrueColorPalette(video_mode_t mode) {
             nr = (int)((r>>3)*t+roundUpR);
             ng = (int)((g>>2)*t+roundUpG);
             nb = (int)((b>>3)*t+roundUpB);
-            Palettes16[((p*256+i)*VID_NUMCOLORWEIGHTS)+w] = (
+            Palettes16[((p*256+i)*VID_NUMCOLORWEIGHTS)+w] = VID_SWAP16(
               (nr<<11) | (ng<<5) | nb
             );
           }
@@ -694,49 +713,56 @@ void V_SetPalette(int pal)
 // CPhipps - New function to fill a rectangle with a given colour
 static void V_FillRect8(int scrn, int x, int y, int width, int height, byte colour)
 {
-  byte* dest = screens[scrn].data + x + y*screens[scrn].byte_pitch;
+  byte* dest = screens[scrn].data + V_PIXOFS(x, y, screens[scrn].byte_pitch);
+#ifdef COLUMN_MAJOR_SCREENS
+  while (width--) {
+    memset(dest, colour, height);
+    dest += screens[scrn].byte_pitch;
+  }
+#else
   while (height--) {
     memset(dest, colour, width);
     dest += screens[scrn].byte_pitch;
   }
+#endif
 }
 
 static void V_FillRect15(int scrn, int x, int y, int width, int height, byte colour)
 {
-  unsigned short* dest = (unsigned short *)screens[scrn].data + x + y*screens[scrn].short_pitch;
+  unsigned short* dest = (unsigned short *)screens[scrn].data + V_PIXOFS(x, y, screens[scrn].short_pitch);
   int w;
   short c = VID_PAL15(colour, VID_COLORWEIGHTMASK);
   while (height--) {
     for (w=0; w<width; w++) {
-      dest[w] = c;
+      dest[w*V_XSTEP(screens[scrn].short_pitch)] = c;
     }
-    dest += screens[scrn].short_pitch;
+    dest += V_YSTEP(screens[scrn].short_pitch);
   }
 }
 
 static void V_FillRect16(int scrn, int x, int y, int width, int height, byte colour)
 {
-  unsigned short* dest = (unsigned short *)screens[scrn].data + x + y*screens[scrn].short_pitch;
+  unsigned short* dest = (unsigned short *)screens[scrn].data + V_PIXOFS(x, y, screens[scrn].short_pitch);
   int w;
   short c = VID_PAL16(colour, VID_COLORWEIGHTMASK);
   while (height--) {
     for (w=0; w<width; w++) {
-      dest[w] = c;
+      dest[w*V_XSTEP(screens[scrn].short_pitch)] = c;
     }
-    dest += screens[scrn].short_pitch;
+    dest += V_YSTEP(screens[scrn].short_pitch);
   }
 }
 
 static void V_FillRect32(int scrn, int x, int y, int width, int height, byte colour)
 {
-  unsigned int* dest = (unsigned int *)screens[scrn].data + x + y*screens[scrn].int_pitch;
+  unsigned int* dest = (unsigned int *)screens[scrn].data + V_PIXOFS(x, y, screens[scrn].int_pitch);
   int w;
   int c = VID_PAL32(colour, VID_COLORWEIGHTMASK);
   while (height--) {
     for (w=0; w<width; w++) {
-      dest[w] = c;
+      dest[w*V_XSTEP(screens[scrn].int_pitch)] = c;
     }
-    dest += screens[scrn].int_pitch;
+    dest += V_YSTEP(screens[scrn].int_pitch);
   }
 }
 
@@ -904,8 +930,8 @@ int V_GetPixelDepth(void) {
 //
 void V_AllocScreen(screeninfo_t *scrn) {
   if (!scrn->not_on_heap)
-    if ((scrn->byte_pitch * scrn->height) > 0)
-      scrn->data = malloc(scrn->byte_pitch*scrn->height);
+    if ((scrn->byte_pitch * V_LINES(scrn)) > 0)
+      scrn->data = malloc(scrn->byte_pitch*V_LINES(scrn));
 }
 
 //
@@ -939,19 +965,19 @@ void V_FreeScreens(void) {
 }
 
 static void V_PlotPixel8(int scrn, int x, int y, byte color) {
-  screens[scrn].data[x+screens[scrn].byte_pitch*y] = color;
+  screens[scrn].data[V_PIXOFS(x, y, screens[scrn].byte_pitch)] = color;
 }
 
 static void V_PlotPixel15(int scrn, int x, int y, byte color) {
-  ((unsigned short *)screens[scrn].data)[x+screens[scrn].short_pitch*y] = VID_PAL15(color, VID_COLORWEIGHTMASK);
+  ((unsigned short *)screens[scrn].data)[V_PIXOFS(x, y, screens[scrn].short_pitch)] = VID_PAL15(color, VID_COLORWEIGHTMASK);
 }
 
 static void V_PlotPixel16(int scrn, int x, int y, byte color) {
-  ((unsigned short *)screens[scrn].data)[x+screens[scrn].short_pitch*y] = VID_PAL16(color, VID_COLORWEIGHTMASK);
+  ((unsigned short *)screens[scrn].data)[V_PIXOFS(x, y, screens[scrn].short_pitch)] = VID_PAL16(color, VID_COLORWEIGHTMASK);
 }
 
 static void V_PlotPixel32(int scrn, int x, int y, byte color) {
-  ((unsigned int *)screens[scrn].data)[x+screens[scrn].int_pitch*y] = VID_PAL32(color, VID_COLORWEIGHTMASK);
+  ((unsigned int *)screens[scrn].data)[V_PIXOFS(x, y, screens[scrn].int_pitch)] = VID_PAL32(color, VID_COLORWEIGHTMASK);
 }
 
 //
@@ -48,18 +48,36 @@
 #include "z_zone.h"
 #include "lprintf.h"
 #include "i_system.h"
+#include "esp_heap_caps.h"
 
 #define RANGECHECK
 
+// Tunables
+
+// Internal RAM the most used lumps are copied into, FASTRAM_BUDGET
+// (config.h). Anything mapped from flash is read through the same 32K
+// cache as PSRAM, which the drawing loops and the sound mixer keep
+// thrashing.
+
+// Bigger lumps are never copied
+#define FASTRAM_MAXLUMP (16*1024)
+
 static struct {
   void *cache;
   void *mmapadr;
+  void *fast;         // copy in internal RAM, or NULL
 #ifdef TIMEDIAG
   int locktic;
 #endif
   int locks;
+  int holds;          // W_CacheLumpNums not yet unlocked
+  unsigned accesses;  // W_CacheLumpNums, halved each level
+  boolean pinned;     // W_PinLumpNum: stays in internal RAM
 } *cachelump;
 
+static int fastused;
+unsigned w_fasthits, w_fastmisses;
+
 
 
 #ifdef HEAPDUMP
@@ -122,8 +140,142 @@ const void* W_CacheLumpNum(int lump)
   if ((unsigned)lump >= (unsigned)numlumps)
     I_Error ("W_CacheLumpNum: %i >= numlumps",lump);
 #endif
-	cachelump[lump].mmapadr=I_Mmap(NULL, W_LumpLength(lump), 0, 0, lumpinfo[lump].wadfile->handle, lumpinfo[lump].position);
-	return (char*)cachelump[lump].mmapadr;
+  const void *data;
+
+  // The render threads cache flats as well
+  I_LockRenderCache();
+  cachelump[lump].accesses++;
+  cachelump[lump].holds++;
+  if ((data = cachelump[lump].fast) != NULL)
+    w_fasthits++;
+  else
+    {
+      w_fastmisses++;
+      data = cachelump[lump].mmapadr = I_Mmap(NULL, W_LumpLength(lump), 0, 0, lumpinfo[lump].wadfile->handle, lumpinfo[lump].position);
+    }
+  I_UnlockRenderCache();
+  return data;
+}
+
+//
+// Fast RAM tiering
+//
+// W_PromoteHotLumps copies the lumps read most often for their size into
+// internal RAM, for as long as FASTRAM_BUDGET lasts, and W_CacheLumpNum
+// hands out the copies from then on. Pointers it handed out before stay
+// valid. W_DemoteLumps drops the copies again, between levels, except
+// for those still held: lumps that are never unlocked, like sound
+// samples, stay once they are in.
+//
+
+static boolean W_PromoteLump(int lump)
+{
+  int len = W_LumpLength(lump);
+  void *fast;
+
+  if (cachelump[lump].fast || !len || len > FASTRAM_MAXLUMP ||
+      fastused + len > FASTRAM_BUDGET || !lumpinfo[lump].wadfile)
+    return false;
+  if (!(fast = heap_caps_malloc(len, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)))
+    return false;
+  memcpy(fast, I_Mmap(NULL, len, 0, 0, lumpinfo[lump].wadfile->handle, lumpinfo[lump].position), len);
+  cachelump[lump].fast = fast;
+  fastused += len;
+  return true;
+}
+
+//
+// W_PinLumpNum
+// W_CacheLumpNum for lumps held for good, from internal RAM if it fits
+//
+
+const void* W_PinLumpNum(int lump)
+{
+  I_LockRenderCache();
+  if (W_PromoteLump(lump))
+    cachelump[lump].pinned = true;
+  I_UnlockRenderCache();
+  return W_CacheLumpNum(lump);
+}
+
+typedef struct {
+  int lump;
+  unsigned density;   // accesses per K
+} hotlump_t;
+
+static int W_CompareHotLumps(const void *a, const void *b)
+{
+  unsigned da = ((const hotlump_t *)a)->density, db = ((const hotlump_t *)b)->density;
+  return da < db ? 1 : da > db ? -1 : 0;
+}
+
+//
+// W_PromoteHotLumps
+// Called by P_SetupLevel once the level is loaded, and every few seconds
+// in it as the budget allows. Copies no more than maxbytes, so a call
+// from P_Ticker costs a tic no more than one big lump's copy.
+//
+
+void W_PromoteHotLumps(int maxbytes)
+{
+  hotlump_t *hot;
+  int i, n = 0, promoted = 0, limit;
+
+  if (fastused >= FASTRAM_BUDGET)
+    return;
+  // The list is only a hint, so do without it when memory is short,
+  // rather than have Z_Malloc evict the cache or give up
+  if (!(hot = heap_caps_malloc(numlumps * sizeof *hot, MALLOC_CAP_SPIRAM)))
+    return;
+
+  for (i=0; i<numlumps; i++)
+    if (cachelump[i].accesses && !cachelump[i].fast &&
+        W_LumpLength(i) && W_LumpLength(i) <= FASTRAM_MAXLUMP)
+      {
+        hot[n].lump = i;
+        hot[n++].density = cachelump[i].accesses * 1024 / W_LumpLength(i);
+      }
+  qsort(hot, n, sizeof *hot, W_CompareHotLumps);
+
+  limit = fastused + maxbytes;
+  I_LockRenderCache();
+  for (i=0; i<n && fastused < FASTRAM_BUDGET && fastused < limit; i++)
+    if (fastused + W_LumpLength(hot[i].lump) <= limit)
+      promoted += W_PromoteLump(hot[i].lump);
+  I_UnlockRenderCache();
+  heap_caps_free(hot);
+
+  if (promoted)
+    lprintf(LO_DEBUG, "W_PromoteHotLumps: %d lumps, %d bytes in use\n", promoted, fastused);
+}
+
+//
+// W_DemoteLumps
+// Called by P_SetupLevel between levels, with nothing drawing
+//
+
+void W_DemoteLumps(void)
+{
+  int i;
+
+  if (w_fasthits + w_fastmisses)
+    lprintf(LO_INFO, "W_DemoteLumps: %u%% of %u lump reads from internal RAM\n",
+            (unsigned)((unsigned long long)w_fasthits * 100 / (w_fasthits + w_fastmisses)),
+            w_fasthits + w_fastmisses);
+  w_fasthits = w_fastmisses = 0;
+
+  I_LockRenderCache();
+  for (i=0; i<numlumps; i++)
+    {
+      if (cachelump[i].fast && !cachelump[i].pinned && cachelump[i].holds <= 0)
+        {
+          heap_caps_free(cachelump[i].fast);
+          cachelump[i].fast = NULL;
+          fastused -= W_LumpLength(i);
+        }
+      cachelump[i].accesses >>= 1;  // older levels count for less
+    }
+  I_UnlockRenderCache();
 }
 
 /*
@@ -136,7 +288,7 @@ const void* W_CacheLumpNum(int lump)
 const void* W_LockLumpNum(int lump)
 {
   size_t len = W_LumpLength(lump);
-  const void *data = W_CacheLumpNum(lump);
+  const void *data = I_Mmap(NULL, len, 0, 0, lumpinfo[lump].wadfile->handle, lumpinfo[lump].position);
 
   if (!cachelump[lump].cache) {
     // read the lump in
@@ -169,6 +321,10 @@ const void* W_LockLumpNum(int lump)
 void W_UnlockLumpNum(int lump) {
   if (cachelump[lump].locks == -1) {
     // this lump is memory mapped
+    I_LockRenderCache();
+    if (cachelump[lump].holds > 0)
+      cachelump[lump].holds--;
+    I_UnlockRenderCache();
     I_Munmap(cachelump[lump].mmapadr, W_LumpLength(lump));
     return;
   }
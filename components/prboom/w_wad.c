@@ -54,6 +54,7 @@
 #pragma implementation "w_wad.h"
 #endif
 #include "w_wad.h"
+#include "d_snapshot.h"
 #include "lprintf.h"
 
 //
@@ -424,10 +425,14 @@ void W_Init(void)
   // killough 4/17/98: Add namespace tags to each entry
   // killough 4/4/98: add colormap markers
 
-  W_CoalesceMarkedResource("S_START", "S_END", ns_sprites);
-  W_CoalesceMarkedResource("F_START", "F_END", ns_flats);
-  W_CoalesceMarkedResource("C_START", "C_END", ns_colormaps);
-  W_CoalesceMarkedResource("B_START", "B_END", ns_prboom);
+  // The directory sorted on an earlier boot, if the wads are the same
+  if (!D_SnapshotLumps())
+    {
+      W_CoalesceMarkedResource("S_START", "S_END", ns_sprites);
+      W_CoalesceMarkedResource("F_START", "F_END", ns_flats);
+      W_CoalesceMarkedResource("C_START", "C_END", ns_colormaps);
+      W_CoalesceMarkedResource("B_START", "B_END", ns_prboom);
+    }
 
   // killough 1/31/98: initialize lump hash table
   W_HashLumps();
@@ -55,6 +55,8 @@
 #include "v_video.h"
 #include "g_game.h"
 #include "lprintf.h"
+#include "i_system.h"
+#include "esp_heap_caps.h"
 
 #ifdef DJGPP
 #include <dpmi.h>
@@ -83,6 +85,30 @@
 // Number of mallocs & frees kept in history buffer (must be a power of 2)
 #define ZONE_HISTORY 4
 
+// Memory zone blocks are malloc'ed from
+#define ZONE_CAPS (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+
+// Free memory below which cached blocks are evicted before malloc'ing more
+#ifndef ZONE_LOW_WATER
+#define ZONE_LOW_WATER (256*1024)
+#endif
+
+// Internal RAM that Z_MallocInternal may use (config.h)
+#ifndef ZONE_INTERNAL_BUDGET
+#define ZONE_INTERNAL_BUDGET (64*1024)
+#endif
+
+// Size and memory of the chunks the level arena is cut from
+#ifndef ARENA_CHUNK
+#define ARENA_CHUNK (64*1024)
+#endif
+#ifndef ARENA_CAPS
+#define ARENA_CAPS (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#endif
+
+// Largest block taken from the level arena; bigger ones are malloc'ed
+#define ARENA_MAXBLOCK (4*1024)
+
 // End Tunables
 
 typedef struct memblock {
@@ -95,6 +121,8 @@ typedef struct memblock {
   size_t size;
   void **user;
   unsigned char tag;
+  unsigned char arena;        // cut from the level arena
+  unsigned char tier;         // ZT_INTERNAL or ZT_PSRAM
 
 #ifdef INSTRUMENTED
   const char *file;
@@ -110,54 +138,118 @@ static const size_t HEADER_SIZE = (sizeof(memblock_t)+CHUNK_SIZE-1) & ~(CHUNK_SI
 
 static memblock_t *blockbytag[PU_MAX];
 
+// The level arena
+//
+// PU_LEVEL and PU_LEVSPEC blocks are bumped off ARENA_CHUNK sized chunks,
+// newest chunk first, and the chunks are freed whole when the level ends
+// instead of the blocks one by one. That is most of the level setup and
+// every thinker, and freeing them one at a time left the PSRAM heap in
+// pieces after a few levels. A block freed before then is kept on a list
+// by size, for the next one of that size: the same few sizes make up
+// nearly all the churn (mobjs, thinkers, secnodes).
+//
+// Only arena blocks with an owner go on blockbytag, so their owners can
+// be cleared; the rest are found through their chunk.
+
+#define Z_IsLevelTag(tag) ((tag) >= PU_LEVEL && (tag) < PU_PURGELEVEL)
+
+typedef struct arenachunk {
+  struct arenachunk *next;
+  size_t used;
+} arenachunk_t;
+
+static const size_t ARENA_HEADER = (sizeof(arenachunk_t)+CHUNK_SIZE-1) & ~(CHUNK_SIZE-1);
+
+static arenachunk_t *arena;
+static memblock_t *arenafree[ARENA_MAXBLOCK/CHUNK_SIZE+1];
+static size_t arena_inuse;    // bytes in arena blocks not freed
+
 // 0 means unlimited, any other value is a hard limit
 //static int memory_size = 8192*1024;
 static int memory_size = 0;
 static int free_memory = 0;
 
-#ifdef INSTRUMENTED
+// Zone accounting, kept all the time; see z_zone.h
+zonestats_t zonestats = { ZONESTATS_MAGIC, sizeof(zonestats_t) };
+int zone_stats;
+static unsigned tic_allocs, tic_bytes;
+
+#define ZONE_TIER(caps) ((caps) & MALLOC_CAP_INTERNAL ? ZT_INTERNAL : ZT_PSRAM)
 
-// statistics for evaluating performance
-static int active_memory = 0;
-static int purgable_memory = 0;
+static void Z_AddStats(int tag, int tier, long delta, int blocks)
+{
+  zonestats.bytes[tag] += delta;
+  zonestats.blocks[tag] += blocks;
+  zonestats.tierbytes[tier] += delta;
+  if (delta > 0)
+  {
+    if (zonestats.bytes[tag] > zonestats.peakbytes[tag])
+      zonestats.peakbytes[tag] = zonestats.bytes[tag];
+    if (zonestats.tierbytes[tier] > zonestats.peaktierbytes[tier])
+      zonestats.peaktierbytes[tier] = zonestats.tierbytes[tier];
+  }
+}
+
+//
+// Z_TicStats
+// Called by G_Ticker. While tntmem is on, shows the stats once a second
+// and sends them to the console as a zonestats_t, framed as z_zone.h says.
+//
 
-static void Z_DrawStats(void)            // Print allocation statistics
+void Z_TicStats(void)
 {
-  if (gamestate != GS_LEVEL)
+  static const uint32_t tiercaps[ZT_MAX] = { MALLOC_CAP_INTERNAL, MALLOC_CAP_SPIRAM };
+  static const char hexdigits[] = "0123456789abcdef";
+  static char line[5 + 2*sizeof zonestats + 2] = "ZST1 ";
+  const unsigned char *p = (const unsigned char *)&zonestats;
+  char *out = line + 5;
+  int i;
+
+  zonestats.tic = gametic;
+  zonestats.ticallocs = tic_allocs;
+  zonestats.ticbytes = tic_bytes;
+  if (tic_allocs > zonestats.peakticallocs)
+    zonestats.peakticallocs = tic_allocs;
+  if (tic_bytes > zonestats.peakticbytes)
+    zonestats.peakticbytes = tic_bytes;
+  tic_allocs = tic_bytes = 0;
+
+  if (!zone_stats || gametic % TICRATE)
     return;
 
-  if (memory_size > 0) {
-    unsigned long total_memory = free_memory + memory_size + active_memory + purgable_memory;
-    double s = 100.0 / total_memory;
-
-    doom_printf("%-5i\t%6.01f%%\tstatic\n"
-            "%-5i\t%6.01f%%\tpurgable\n"
-            "%-5i\t%6.01f%%\tfree\n"
-            "%-5li\t\ttotal\n",
-            active_memory,
-            active_memory*s,
-            purgable_memory,
-            purgable_memory*s,
-            (free_memory + memory_size),
-            (free_memory + memory_size)*s,
-            total_memory
-            );
-  } else {
-    unsigned long total_memory = active_memory + purgable_memory;
-    double s = 100.0 / total_memory;
-
-    doom_printf("%-5i\t%6.01f%%\tstatic\n"
-            "%-5i\t%6.01f%%\tpurgable\n"
-            "%-5li\t\ttotal\n",
-            active_memory,
-            active_memory*s,
-            purgable_memory,
-            purgable_memory*s,
-            total_memory
-            );
+  for (i=0; i<ZT_MAX; i++)
+  {
+    zonestats.heapfree[i] = heap_caps_get_free_size(tiercaps[i]);
+    zonestats.heapminfree[i] = heap_caps_get_minimum_free_size(tiercaps[i]);
+    zonestats.heaplargest[i] = heap_caps_get_largest_free_block(tiercaps[i]);
   }
+
+  if (gamestate == GS_LEVEL)
+    doom_printf("zone KB: static %u level %u cache %u\n"
+                "int %uKB (%u free) psram %uKB (%u free)\n"
+                "allocs/tic %u (max %u), evicted %u",
+                zonestats.bytes[PU_STATIC] / 1024,
+                (zonestats.bytes[PU_LEVEL] + zonestats.bytes[PU_LEVSPEC]) / 1024,
+                zonestats.bytes[PU_CACHE] / 1024,
+                zonestats.tierbytes[ZT_INTERNAL] / 1024, zonestats.heapfree[ZT_INTERNAL] / 1024,
+                zonestats.tierbytes[ZT_PSRAM] / 1024, zonestats.heapfree[ZT_PSRAM] / 1024,
+                zonestats.ticallocs, zonestats.peakticallocs, zonestats.evictions);
+
+  // One fputs of a whole line, so other output goes before or after it
+  for (i=0; i<(int)sizeof zonestats; i++)
+  {
+    *out++ = hexdigits[p[i] >> 4];
+    *out++ = hexdigits[p[i] & 15];
+  }
+  *out++ = '\n';
+  *out = 0;
+  fflush(stdout);
+  fputs(line, stdout);
+  fflush(stdout);
 }
 
+#ifdef INSTRUMENTED
+
 #ifdef HEAPDUMP
 
 #ifndef HEAPDUMP_DIR
@@ -175,8 +267,9 @@ void Z_DumpMemory(void)
   int tag;
 
   sprintf(buf, "%s/memdump.%d", HEAPDUMP_DIR, dump++);
-//  fp = fopen(buf, "w");
-  fp=NULL;
+  fp = fopen(buf, "w");
+  if (!fp)
+    return;
   for (tag = PU_FREE; tag < PU_MAX; tag++)
   {
     memblock_t* end_block, *block;
@@ -320,6 +413,85 @@ void Z_Init(void)
 #endif
 }
 
+static memblock_t *Z_ArenaAlloc(size_t size)
+{
+  memblock_t *block = arenafree[size/CHUNK_SIZE];
+
+  if (block)
+    arenafree[size/CHUNK_SIZE] = block->next;
+  else
+  {
+    if (!arena || arena->used + HEADER_SIZE + size > ARENA_CHUNK)
+    {
+      arenachunk_t *chunk = heap_caps_aligned_alloc(64, ARENA_CHUNK, ARENA_CAPS);
+      if (!chunk)
+        return NULL;          // the caller mallocs it instead
+      chunk->next = arena;
+      chunk->used = ARENA_HEADER;
+      arena = chunk;
+    }
+    block = (memblock_t *)((char *) arena + arena->used);
+    arena->used += HEADER_SIZE + size;
+  }
+  arena_inuse += size;
+  return block;
+}
+
+static void Z_FreeArena(void)
+{
+  unsigned long starttime = I_GetTimeUS();
+  size_t used = 0;
+  int chunks = 0, tag;
+
+  while (arena)
+  {
+    arenachunk_t *next = arena->next;
+    used += arena->used;
+    chunks++;
+    (free)(arena);
+    arena = next;
+  }
+  memset(arenafree, 0, sizeof arenafree);
+
+  // What's left on the level tags is the unlisted arena blocks
+  free_memory += arena_inuse;
+  arena_inuse = 0;
+  for (tag = PU_LEVEL; tag < PU_PURGELEVEL; tag++)
+    Z_AddStats(tag, ZONE_TIER(ARENA_CAPS), -(long)zonestats.bytes[tag], -(int)zonestats.blocks[tag]);
+
+  if (chunks)
+    lprintf(LO_INFO, "Z_FreeTags: level arena %d chunks, %luKB used, freed in %luus, "
+            "largest free block %luKB\n", chunks, (unsigned long)used / 1024,
+            I_GetTimeUS() - starttime,
+            (unsigned long)heap_caps_get_largest_free_block(ARENA_CAPS) / 1024);
+}
+
+//
+// Z_EvictCache
+// PU_CACHE blocks join the end of their list when they're unlocked, so the
+// list runs from least to most recently used. Frees from the front until
+// at least want bytes have gone, rather than the whole cache: everything
+// in use again next frame would be rebuilt at once.
+//
+
+static void Z_EvictCache(size_t want)
+{
+  unsigned long starttime = I_GetTimeUS();
+  size_t freed = 0;
+
+  while (blockbytag[PU_CACHE] && freed < want)
+  {
+    memblock_t *block = blockbytag[PU_CACHE];
+    freed += block->size + HEADER_SIZE;
+    zonestats.evictions++;
+    (Z_Free)((char *) block + HEADER_SIZE DA(__FILE__, __LINE__));
+  }
+  if (freed)
+    zonestats.purges++;
+  zonestats.evictbytes += freed;
+  zonestats.evictus += I_GetTimeUS() - starttime;
+}
+
 /* Z_Malloc
  * You can pass a NULL user if the tag is < PU_PURGELEVEL.
  *
@@ -331,8 +503,7 @@ void Z_Init(void)
  * but we only free the blocks we actually end up using; we don't 
  * free all the stuff we just pass on the way.
  */
-#include "esp_heap_caps.h"
-void *(Z_Malloc)(size_t size, int tag, void **user
+static void *Z_MallocTier(size_t size, int tag, void **user, boolean internal
 #ifdef INSTRUMENTED
      , const char *file, int line
 #endif
@@ -364,6 +535,12 @@ void *(Z_Malloc)(size_t size, int tag, void **user
 
   size = (size+CHUNK_SIZE-1) & ~(CHUNK_SIZE-1);  // round to chunk size
 
+#ifdef PIPELINE_RENDER
+  // The second half of a pipelined frame caches patches and composites
+  // on the other core while the game allocates
+  I_LockRenderCache();
+#endif
+
   if (memory_size > 0 && ((free_memory + memory_size) < (int)(size + HEADER_SIZE)))
   {
     memblock_t *end_block;
@@ -387,26 +564,54 @@ void *(Z_Malloc)(size_t size, int tag, void **user
     block = NULL;
   }
 
+  if (internal && zonestats.tierbytes[ZT_INTERNAL] + size <= ZONE_INTERNAL_BUDGET)
+    block = heap_caps_malloc(size + HEADER_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+  if (block)
+  {
+    block->arena = false;
+    block->tier = ZT_INTERNAL;
+  }
+  else if (Z_IsLevelTag(tag) && size <= ARENA_MAXBLOCK && (block = Z_ArenaAlloc(size)) != NULL)
+  {
+    block->arena = true;
+    block->tier = ZONE_TIER(ARENA_CAPS);
+  }
+  else
+  {
+    // Make room before the heap runs out, not after
+    if (blockbytag[PU_CACHE])
+    {
+      size_t avail = heap_caps_get_free_size(ZONE_CAPS);
+      if (avail < ZONE_LOW_WATER + size + HEADER_SIZE)
+        Z_EvictCache(ZONE_LOW_WATER + size + HEADER_SIZE - avail);
+    }
+
 #ifdef HAVE_LIBDMALLOC
-  while (!(block = dmalloc_malloc(file,line,size + HEADER_SIZE,DMALLOC_FUNC_MALLOC,0,0))) {
+    while (!(block = dmalloc_malloc(file,line,size + HEADER_SIZE,DMALLOC_FUNC_MALLOC,0,0))) {
 #else
-  //while (!(block = (malloc)(size + HEADER_SIZE))) {
-  while (!(block = heap_caps_aligned_alloc(64, size + HEADER_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT))) {
+    //while (!(block = (malloc)(size + HEADER_SIZE))) {
+    while (!(block = heap_caps_aligned_alloc(64, size + HEADER_SIZE, ZONE_CAPS))) {
 #endif
-    if (!blockbytag[PU_CACHE])
-      I_Error ("Z_Malloc: Failure trying to allocate %lu bytes"
+      if (!blockbytag[PU_CACHE])
+        I_Error ("Z_Malloc: Failure trying to allocate %lu bytes"
 #ifdef INSTRUMENTED
-               "\nSource: %s:%d"
+                 "\nSource: %s:%d"
 #endif
-               ,(unsigned long) size
+                 ,(unsigned long) size
 #ifdef INSTRUMENTED
-               , file, line
+                 , file, line
 #endif
-      );
-    Z_FreeTags(PU_CACHE,PU_CACHE);
+        );
+      Z_EvictCache(size + HEADER_SIZE);
+    }
+    block->arena = false;
+    block->tier = ZONE_TIER(ZONE_CAPS);
   }
 
-  if (!blockbytag[tag])
+  if (block->arena && !user)
+    block->next = block->prev = NULL;
+  else if (!blockbytag[tag])
   {
     blockbytag[tag] = block;
     block->next = block->prev = block;
@@ -421,12 +626,10 @@ void *(Z_Malloc)(size_t size, int tag, void **user
     
   block->size = size;
 
-#ifdef INSTRUMENTED
-  if (tag >= PU_PURGELEVEL)
-    purgable_memory += block->size;
-  else
-    active_memory += block->size;
-#endif
+  Z_AddStats(tag, block->tier, size, 1);
+  zonestats.allocs++;
+  tic_allocs++;
+  tic_bytes += size;
   free_memory -= block->size;
 
 #ifdef INSTRUMENTED
@@ -444,14 +647,41 @@ void *(Z_Malloc)(size_t size, int tag, void **user
     *user = block;            // set user to point to new block
   
 #ifdef INSTRUMENTED
-  Z_DrawStats();           // print memory allocation stats
   // scramble memory -- weed out any bugs
   memset(block, gametic & 0xff, size);
 #endif
 
+#ifdef PIPELINE_RENDER
+  I_UnlockRenderCache();
+#endif
   return block;
 }
 
+void *(Z_Malloc)(size_t size, int tag, void **user
+#ifdef INSTRUMENTED
+     , const char *file, int line
+#endif
+     )
+{
+  return Z_MallocTier(size, tag, user, false DA(file, line));
+}
+
+//
+// Z_MallocInternal
+// For the tables the game reads all the time: from internal RAM while
+// ZONE_INTERNAL_BUDGET allows, from the zone after that. Either way the
+// block is freed and purged like any other.
+//
+
+void *(Z_MallocInternal)(size_t size, int tag, void **user
+#ifdef INSTRUMENTED
+     , const char *file, int line
+#endif
+     )
+{
+  return Z_MallocTier(size, tag, user, true DA(file, line));
+}
+
 void (Z_Free)(void *p
 #ifdef INSTRUMENTED
               , const char *file, int line
@@ -472,6 +702,9 @@ void (Z_Free)(void *p
   if (!p)
     return;
 
+#ifdef PIPELINE_RENDER
+  I_LockRenderCache();
+#endif
 
 #ifdef ZONEIDCHECK
   if (block->id != ZONEID)
@@ -488,32 +721,51 @@ void (Z_Free)(void *p
   if (block->user)            // Nullify user if one exists
     *block->user = NULL;
 
-  if (block == block->next)
+  if (!block->next)
+    ;                         // unlisted arena block
+  else if (block == block->next)
     blockbytag[block->tag] = NULL;
   else
+  {
     if (blockbytag[block->tag] == block)
       blockbytag[block->tag] = block->next;
-  block->prev->next = block->next;
-  block->next->prev = block->prev;
+    block->prev->next = block->next;
+    block->next->prev = block->prev;
+  }
 
   free_memory += block->size;
+  Z_AddStats(block->tag, block->tier, -(long)block->size, -1);
+  zonestats.frees++;
+
+  if (block->arena)
+  {
+    size_t size = block->size;
 #ifdef INSTRUMENTED
-  if (block->tag >= PU_PURGELEVEL)
-    purgable_memory -= block->size;
+    memset(block, gametic & 0xff, size + HEADER_SIZE);
+    block->size = size;
+    block->arena = true;
+#endif
+    arena_inuse -= size;
+    block->tag = PU_FREE;
+    block->user = NULL;
+    block->next = arenafree[size/CHUNK_SIZE];
+    arenafree[size/CHUNK_SIZE] = block;
+  }
   else
-    active_memory -= block->size;
-
-  /* scramble memory -- weed out any bugs */
-  memset(block, gametic & 0xff, block->size + HEADER_SIZE);
+  {
+#ifdef INSTRUMENTED
+    /* scramble memory -- weed out any bugs */
+    memset(block, gametic & 0xff, block->size + HEADER_SIZE);
 #endif
 
 #ifdef HAVE_LIBDMALLOC
-  dmalloc_free(file,line,block,DMALLOC_FUNC_MALLOC);
+    dmalloc_free(file,line,block,DMALLOC_FUNC_MALLOC);
 #else
-  (free)(block);
+    (free)(block);
 #endif
-#ifdef INSTRUMENTED
-      Z_DrawStats();           // print memory allocation stats
+  }
+#ifdef PIPELINE_RENDER
+  I_UnlockRenderCache();
 #endif
 }
 
@@ -523,6 +775,9 @@ void (Z_FreeTags)(int lowtag, int hightag
 #endif
                  )
 {
+  // The arena goes when all of the level tags do
+  boolean level = lowtag <= PU_LEVEL && hightag >= PU_PURGELEVEL-1;
+
 #ifdef HEAPDUMP
   Z_DumpMemory();
 #endif
@@ -533,6 +788,9 @@ void (Z_FreeTags)(int lowtag, int hightag
   if (hightag > PU_CACHE)
     hightag = PU_CACHE;
 
+#ifdef PIPELINE_RENDER
+  I_LockRenderCache();
+#endif
   for (;lowtag <= hightag; lowtag++)
   {
     memblock_t *block, *end_block;
@@ -553,6 +811,11 @@ void (Z_FreeTags)(int lowtag, int hightag
       block = next;               // Advance to next block
     }
   }
+  if (level)
+    Z_FreeArena();
+#ifdef PIPELINE_RENDER
+  I_UnlockRenderCache();
+#endif
 }
 
 void (Z_ChangeTag)(void *ptr, int tag
@@ -598,42 +861,53 @@ void (Z_ChangeTag)(void *ptr, int tag
 
 #endif // ZONEIDCHECK
 
-  if (block == block->next)
-    blockbytag[block->tag] = NULL;
-  else
-    if (blockbytag[block->tag] == block)
-      blockbytag[block->tag] = block->next;
-  block->prev->next = block->next;
-  block->next->prev = block->prev;
+  // Its chunk is freed with the level
+  if (block->arena && !Z_IsLevelTag(tag))
+    I_Error ("Z_ChangeTag: level block can't outlive the level"
+#ifdef INSTRUMENTED
+             "\nSource: %s:%d"
+             "\nSource of malloc: %s:%d"
+             , file, line, block->file, block->line
+#endif
+            );
 
-  if (!blockbytag[tag])
-  {
-    blockbytag[tag] = block;
-    block->next = block->prev = block;
-  }
+#ifdef PIPELINE_RENDER
+  I_LockRenderCache();
+#endif
+  if (!block->next)
+    ;                         // unlisted arena block, stays so
   else
   {
-    blockbytag[tag]->prev->next = block;
-    block->prev = blockbytag[tag]->prev;
-    block->next = blockbytag[tag];
-    blockbytag[tag]->prev = block;
-  }
+    if (block == block->next)
+      blockbytag[block->tag] = NULL;
+    else
+    {
+      if (blockbytag[block->tag] == block)
+        blockbytag[block->tag] = block->next;
+      block->prev->next = block->next;
+      block->next->prev = block->prev;
+    }
 
-#ifdef INSTRUMENTED
-  if (block->tag < PU_PURGELEVEL && tag >= PU_PURGELEVEL)
-  {
-    active_memory -= block->size;
-    purgable_memory += block->size;
-  }
-  else
-    if (block->tag >= PU_PURGELEVEL && tag < PU_PURGELEVEL)
+    if (!blockbytag[tag])
     {
-      active_memory += block->size;
-      purgable_memory -= block->size;
+      blockbytag[tag] = block;
+      block->next = block->prev = block;
     }
-#endif
+    else
+    {
+      blockbytag[tag]->prev->next = block;
+      block->prev = blockbytag[tag]->prev;
+      block->next = blockbytag[tag];
+      blockbytag[tag]->prev = block;
+    }
+  }
 
+  Z_AddStats(block->tag, block->tier, -(long)block->size, -1);
+  Z_AddStats(tag, block->tier, block->size, 1);
   block->tag = tag;
+#ifdef PIPELINE_RENDER
+  I_UnlockRenderCache();
+#endif
 }
 
 void *(Z_Realloc)(void *ptr, size_t n, int tag, void **user